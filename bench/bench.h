@@ -0,0 +1,59 @@
+#ifndef GRAAL_BENCH
+#define GRAAL_BENCH
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace bench
+{
+	using Caso = void (*)();
+
+	/// Lista de casos registrados pela macro BENCH
+	std::vector< std::pair< const char *, Caso > > &casos();
+
+	/// Registra um caso de benchmark durante a inicializacao estatica
+	struct Registro
+	{
+		Registro( const char *nome, Caso c ) { casos().emplace_back( nome, c ); }
+	};
+
+	/// Impede que o compilador descarte um resultado que nao eh usado
+	template < typename T >
+	inline void consome( const T &v )
+	{
+		asm volatile( "" : : "g"(&v) : "memory" );
+	}
+
+	/* nome: rotulo impresso no relatorio;
+	 * n: quantidade de elementos processados em cada repeticao;
+	 * f: funcao medida; eh executada varias vezes e o melhor tempo eh reportado;
+	 */
+	template < typename F >
+	double mede( const char *nome, size_t n, F f, int reps = 7 )
+	{
+		using relogio = std::chrono::steady_clock;
+		double melhor = 1e300;
+
+		for(int r = 0; r < reps; ++r)
+		{
+			auto ini = relogio::now();
+			f();
+			auto fim = relogio::now();
+			double ns = std::chrono::duration< double, std::nano >( fim-ini ).count();
+			if(ns < melhor)
+				melhor = ns;
+		}
+
+		std::printf( "  %-44s %10.3f ns/elem %12.3f ms\n", nome, melhor/n, melhor/1e6 );
+		return melhor;
+	}
+}
+
+#define BENCH(nome) \
+	static void nome(); \
+	static bench::Registro registro_##nome( #nome, nome ); \
+	static void nome()
+
+#endif
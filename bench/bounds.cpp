@@ -0,0 +1,92 @@
+#include <vector>
+#include <cstdlib>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara lower_bound sem desvios (com prefetch) com a busca binaria
+// classica, com desvio, as duas chamando cmp pelo mesmo ponteiro de funcao.
+// Consultas em posicoes aleatorias, em um array que cabe na cache L2 e em
+// outro muito maior que a cache.
+
+namespace
+{
+	const size_t Q = 1 << 20;
+
+	bool int_menor( const void *a, const void *b )
+	{
+		return *static_cast< const int * >(a) < *static_cast< const int * >(b);
+	}
+
+	// Lido em tempo de execucao, para que nenhuma das versoes faca inline de cmp
+	graal::Compare volatile menor = int_menor;
+
+	const void *classica( const void *first, const void *last, size_t sz, const void *value,
+			graal::Compare cmp )
+	{
+		const unsigned char *base = (const unsigned char*) first;
+		size_t n = ((const unsigned char*) last - base) / sz;
+		while(n > 0)
+		{
+			size_t metade = n/2;
+			const unsigned char *meio = base + metade*sz;
+			if(cmp(meio, value))
+			{
+				base = meio + sz;
+				n -= metade+1;
+			}
+			else
+				n = metade;
+		}
+		return base;
+	}
+
+	void compara( size_t n, const char *antigo, const char *novo )
+	{
+		std::vector< int > v( n );
+		for(size_t i = 0; i < n; ++i)
+			v[i] = int(2*i);
+		std::vector< int > q( Q );
+		std::srand( 17 );
+		for(auto &x : q)
+			x = int((((size_t) std::rand() << 16) ^ std::rand()) % (2*n));
+		const int *f = v.data(), *l = v.data()+n;
+		graal::Compare cmp = menor;
+
+		bench::mede( antigo, Q, [&]{
+			for(int x : q)
+				bench::consome( classica( f, l, sizeof(int), &x, cmp ) ); }, 3 );
+		bench::mede( novo, Q, [&]{
+			for(int x : q)
+				bench::consome( graal::lower_bound( f, l, sizeof(int), &x, cmp ) ); }, 3 );
+	}
+}
+
+BENCH(lower_bound)
+{
+	compara( 1 << 18, "busca binaria classica (1 MB)", "lower_bound sem desvios (1 MB)" );
+	compara( 1 << 25, "busca binaria classica (128 MB)", "lower_bound sem desvios (128 MB)" );
+}
+
+// Mesmas consultas, uma de cada vez e em lote com batch_lower_bound
+BENCH(batch_lower_bound)
+{
+	const size_t n = 1 << 25;
+	std::vector< int > v( n );
+	for(size_t i = 0; i < n; ++i)
+		v[i] = int(2*i);
+	std::vector< int > q( Q );
+	std::srand( 19 );
+	for(auto &x : q)
+		x = int((((size_t) std::rand() << 16) ^ std::rand()) % (2*n));
+	std::vector< size_t > out( Q );
+	const int *f = v.data(), *l = v.data()+n;
+	graal::Compare cmp = menor;
+
+	bench::mede( "lower_bound, uma chave por vez (128 MB)", Q, [&]{
+		for(size_t i = 0; i < Q; ++i)
+			out[i] = (const int*) graal::lower_bound( f, l, sizeof(int), &q[i], cmp ) - f;
+		bench::consome( out[0] ); }, 3 );
+	bench::mede( "batch_lower_bound (128 MB)", Q, [&]{
+		graal::batch_lower_bound( f, l, sizeof(int), q.data(), Q, out.data(), cmp );
+		bench::consome( out[0] ); }, 3 );
+}
@@ -0,0 +1,182 @@
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara o custo por elemento das versoes void* (um ponteiro de funcao por
+// elemento) com a camada tipada, que recebe lambdas e eh compilada inline, e
+// com os predicados em lote (uma chamada a cada BATCH_SIZE elementos).
+
+namespace
+{
+	const size_t N = 1 << 22;
+
+	bool int_menor( const void *a, const void *b )
+	{
+		return *static_cast< const int * >(a) < *static_cast< const int * >(b);
+	}
+
+	bool int_negativo( const void *a )
+	{
+		return *static_cast< const int * >(a) < 0;
+	}
+
+	bool int_par( const void *a )
+	{
+		return *static_cast< const int * >(a) % 2 == 0;
+	}
+
+	bool char_z( const void *a )
+	{
+		return *static_cast< const char * >(a) == 'z';
+	}
+
+	/// Versoes em lote: o laco interno eh vetorizado pelo compilador
+	size_t int_negativo_lote( const void *bloco, size_t n, size_t, std::uint8_t *out )
+	{
+		const int *v = static_cast< const int * >(bloco);
+		size_t c = 0;
+		for(size_t i = 0; i < n; ++i)
+		{
+			out[i] = v[i] < 0;
+			c += out[i];
+		}
+		return c;
+	}
+
+	size_t int_par_lote( const void *bloco, size_t n, size_t, std::uint8_t *out )
+	{
+		const int *v = static_cast< const int * >(bloco);
+		size_t c = 0;
+		for(size_t i = 0; i < n; ++i)
+		{
+			out[i] = v[i] % 2 == 0;
+			c += out[i];
+		}
+		return c;
+	}
+
+	std::vector< int > ints()
+	{
+		std::vector< int > v( N );
+		std::srand( 42 );
+		for(auto &x : v)
+			x = std::rand() % 1000000;
+		return v;
+	}
+}
+
+BENCH(callbacks_min_int)
+{
+	auto v = ints();
+	const int *f = v.data(), *l = v.data()+v.size();
+
+	bench::mede( "void* min (Compare)", N, [&]{
+		bench::consome( graal::min( f, l, sizeof(int), int_menor ) ); } );
+	bench::mede( "tipado min (lambda)", N, [&]{
+		bench::consome( graal::min( f, l, []( int a, int b ) { return a < b; } ) ); } );
+}
+
+BENCH(callbacks_find_if_int)
+{
+	auto v = ints();
+	const int *f = v.data(), *l = v.data()+v.size();
+
+	bench::mede( "void* find_if (Predicate)", N, [&]{
+		bench::consome( graal::find_if( f, l, sizeof(int), int_negativo ) ); } );
+	bench::mede( "tipado find_if (lambda)", N, [&]{
+		bench::consome( graal::find_if( f, l, []( int a ) { return a < 0; } ) ); } );
+	bench::mede( "void* none_of (Predicate)", N, [&]{
+		bench::consome( graal::none_of( f, l, sizeof(int), int_negativo ) ); } );
+	bench::mede( "tipado none_of (lambda)", N, [&]{
+		bench::consome( graal::none_of( f, l, []( int a ) { return a < 0; } ) ); } );
+}
+
+BENCH(callbacks_find_if_char)
+{
+	std::vector< char > v( N, 'a' );
+	const char *f = v.data(), *l = v.data()+v.size();
+
+	bench::mede( "void* find_if (Predicate)", N, [&]{
+		bench::consome( graal::find_if( f, l, sizeof(char), char_z ) ); } );
+	bench::mede( "tipado find_if (lambda)", N, [&]{
+		bench::consome( graal::find_if( f, l, []( char c ) { return c == 'z'; } ) ); } );
+}
+
+BENCH(callbacks_partition_int)
+{
+	auto v = ints();
+	std::vector< int > w;
+
+	bench::mede( "void* partition (Predicate)", N, [&]{
+		w = v;
+		bench::consome( graal::partition( w.data(), w.data()+w.size(), sizeof(int), int_par ) ); } );
+	bench::mede( "tipado partition (lambda)", N, [&]{
+		w = v;
+		bench::consome( graal::partition( w.data(), w.data()+w.size(), []( int a ) { return a % 2 == 0; } ) ); } );
+}
+
+BENCH(callbacks_lote_int)
+{
+	auto v = ints();
+	const int *f = v.data(), *l = v.data()+v.size();
+	std::vector< int > w;
+
+	bench::mede( "void* none_of (Predicate)", N, [&]{
+		bench::consome( graal::none_of( f, l, sizeof(int), int_negativo ) ); } );
+	bench::mede( "void* none_of (BatchPredicate)", N, [&]{
+		bench::consome( graal::none_of( f, l, sizeof(int), int_negativo_lote ) ); } );
+	bench::mede( "void* partition (Predicate)", N, [&]{
+		w = v;
+		bench::consome( graal::partition( w.data(), w.data()+w.size(), sizeof(int), int_par ) ); } );
+	bench::mede( "void* partition (BatchPredicate)", N, [&]{
+		w = v;
+		bench::consome( graal::partition( w.data(), w.data()+w.size(), sizeof(int), int_par_lote ) ); } );
+}
+
+namespace
+{
+	/// Registro com a chave em um campo no meio
+	struct Registro { std::uint32_t id; int chave; double peso; };
+
+	bool registro_menor( const void *a, const void *b )
+	{
+		return static_cast< const Registro * >(a)->chave < static_cast< const Registro * >(b)->chave;
+	}
+
+	bool registro_igual( const void *a, const void *b )
+	{
+		return static_cast< const Registro * >(a)->chave == static_cast< const Registro * >(b)->chave;
+	}
+}
+
+// Mesmas operacoes sobre registros com Compare/Equal e com Key
+BENCH(callbacks_key)
+{
+	const size_t n = N/4;
+	std::vector< Registro > v( n );
+	std::srand( 8 );
+	for(size_t i = 0; i < n; ++i)
+		v[i] = Registro{ (std::uint32_t) i, std::rand() % 1000000, 1.0 };
+	const Registro *f = v.data(), *l = v.data()+n;
+	graal::Key key( offsetof(Registro, chave), graal::ElementType::Int32 );
+	Registro alvo{ 0, -1, 0 };
+	std::vector< Registro > w;
+
+	bench::mede( "min registro (Compare)", n, [&]{
+		bench::consome( graal::min( f, l, sizeof(Registro), registro_menor ) ); } );
+	bench::mede( "min registro (Key)", n, [&]{
+		bench::consome( graal::min( f, l, sizeof(Registro), key ) ); } );
+	bench::mede( "find registro (Equal)", n, [&]{
+		bench::consome( graal::find( f, l, sizeof(Registro), &alvo, registro_igual ) ); } );
+	bench::mede( "find registro (Key)", n, [&]{
+		bench::consome( graal::find( f, l, sizeof(Registro), &alvo.chave, key ) ); } );
+	bench::mede( "qsort registro (Compare)", n, [&]{
+		w = v;
+		graal::qsort( w.data(), n, sizeof(Registro), registro_menor ); }, 3 );
+	bench::mede( "qsort registro (Key)", n, [&]{
+		w = v;
+		graal::qsort( w.data(), n, sizeof(Registro), key ); }, 3 );
+}
@@ -0,0 +1,38 @@
+#include <vector>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara clone com new[]/delete[] a cada chamada com clone em uma Arena
+// reiniciada periodicamente, para muitos intervalos pequenos.
+
+namespace
+{
+	const size_t CHAMADAS = 1 << 20;
+}
+
+BENCH(clone_arena)
+{
+	int A[32];
+	for(int i = 0; i < 32; ++i)
+		A[i] = i;
+
+	bench::mede( "clone new[]/delete[] (32 ints)", CHAMADAS, [&]{
+		for(size_t i = 0; i < CHAMADAS; ++i)
+		{
+			int *c = static_cast< int * >( graal::clone( A, A+1+i%32, sizeof(int) ) );
+			bench::consome( c[0] );
+			delete [] c;
+		}
+	} );
+
+	bench::mede( "clone Arena::local (32 ints)", CHAMADAS, [&]{
+		graal::Arena &arena = graal::Arena::local();
+		for(size_t i = 0; i < CHAMADAS; ++i)
+		{
+			graal::Buffer c = graal::clone( A, A+1+i%32, sizeof(int), arena );
+			bench::consome( c.as< int >()[0] );
+			if(i % 1024 == 0)
+				arena.reset();
+		}
+	} );
+}
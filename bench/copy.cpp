@@ -0,0 +1,35 @@
+#include <vector>
+#include <cstring>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara a copia antiga (um memcpy por elemento) com a copia em bloco,
+// com e sem stores nao temporais, em um intervalo de 256 MiB.
+
+namespace
+{
+	const size_t BYTES = (size_t) 256 << 20;
+
+	/// Copia como era feita antes: um memcpy de sz bytes por elemento
+	__attribute__((noinline)) void copy_por_elemento( const void *first, const void *last, void *d, size_t sz )
+	{
+		const unsigned char *it = (const unsigned char*) first;
+		unsigned char *d_it = (unsigned char*) d;
+		for(; it!=last; it += sz, d_it += sz)
+			std::memcpy(d_it, it, sz);
+	}
+}
+
+BENCH(copy_bulk)
+{
+	std::vector< int > a( BYTES/sizeof(int), 1 ), b( BYTES/sizeof(int), 0 );
+	size_t n = a.size();
+	const int *f = a.data(), *l = a.data()+n;
+	volatile size_t sz = sizeof(int);
+
+	// Resultados em ns/elem de 4 bytes; GB/s = 4/(ns/elem)
+	bench::mede( "memcpy por elemento", n, [&]{ copy_por_elemento( f, l, b.data(), sz ); bench::consome( b[0] ); }, 3 );
+	bench::mede( "copy Cached", n, [&]{ graal::copy( f, l, b.data(), sz, graal::CopyMode::Cached ); bench::consome( b[0] ); }, 3 );
+	bench::mede( "copy Streaming", n, [&]{ graal::copy( f, l, b.data(), sz, graal::CopyMode::Streaming ); bench::consome( b[0] ); }, 3 );
+	bench::mede( "memcpy (referencia)", n, [&]{ std::memcpy( b.data(), f, BYTES ); bench::consome( b[0] ); }, 3 );
+}
@@ -0,0 +1,37 @@
+#include <vector>
+#include <cstdlib>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara equal e mismatch com Equal (uma chamada por elemento) com o modo
+// bit a bit, em dois buffers grandes que so diferem no ultimo elemento.
+
+namespace
+{
+	const size_t N = 1 << 24;
+
+	bool int_igual( const void *a, const void *b )
+	{
+		return *static_cast< const int * >(a) == *static_cast< const int * >(b);
+	}
+}
+
+BENCH(equal_int)
+{
+	std::vector< int > a( N );
+	std::srand( 3 );
+	for(auto &x : a)
+		x = std::rand();
+	std::vector< int > b = a;
+	b[N-1] ^= 1;
+	const int *fa = a.data(), *la = a.data()+N, *fb = b.data();
+
+	bench::mede( "equal (Equal)", N, [&]{
+		bench::consome( graal::equal( fa, la, fb, sizeof(int), int_igual ) ); } );
+	bench::mede( "equal (bitwise, memcmp)", N, [&]{
+		bench::consome( graal::equal( fa, la, fb, sizeof(int), graal::bitwise ) ); } );
+	bench::mede( "mismatch (Equal)", N, [&]{
+		bench::consome( graal::mismatch( fa, la, fb, sizeof(int), int_igual ).first ); } );
+	bench::mede( "mismatch (bitwise)", N, [&]{
+		bench::consome( graal::mismatch( fa, la, fb, sizeof(int), graal::bitwise ).first ); } );
+}
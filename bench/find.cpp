@@ -0,0 +1,68 @@
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara find com Equal (ponteiro de funcao por elemento) com a busca bit a
+// bit vetorizada, procurando um valor que so aparece no fim do intervalo.
+
+namespace
+{
+	const size_t N = 1 << 24;
+
+	template < typename T >
+	bool igual( const void *a, const void *b )
+	{
+		return *static_cast< const T * >(a) == *static_cast< const T * >(b);
+	}
+
+	template < typename T >
+	void compara( const char *antigo, const char *novo )
+	{
+		size_t n = N/sizeof(T);
+		std::vector< T > v( n, T(1) );
+		v.back() = T(2);
+		T alvo = T(2);
+		const T *f = v.data(), *l = v.data()+n;
+
+		bench::mede( antigo, n, [&]{ bench::consome( graal::find( f, l, sizeof(T), &alvo, igual< T > ) ); } );
+		bench::mede( novo, n, [&]{ bench::consome( graal::find( f, l, sizeof(T), &alvo, graal::bitwise ) ); } );
+	}
+}
+
+BENCH(find_bitwise)
+{
+	compara< std::uint8_t >( "find uint8 Equal", "find uint8 bit a bit" );
+	compara< std::uint16_t >( "find uint16 Equal", "find uint16 bit a bit" );
+	compara< std::uint32_t >( "find uint32 Equal", "find uint32 bit a bit" );
+	compara< std::uint64_t >( "find uint64 Equal", "find uint64 bit a bit" );
+}
+
+// search: um padrao de 16 registros de 8 bytes ausente do intervalo, com
+// Equal (todas as posicoes) e bit a bit (Horspool); search_n de uma sequencia
+// de 32 zeros que so aparece no fim.
+BENCH(search)
+{
+	const size_t n = N/8;
+	std::vector< std::uint64_t > v( n );
+	std::srand( 13 );
+	for(auto &x : v)
+		x = std::rand() % 1000;
+	std::vector< std::uint64_t > s( v.begin() + n/2, v.begin() + n/2 + 16 );
+	s[15] = 5000;
+	const std::uint64_t *f = v.data(), *l = v.data()+n;
+
+	bench::mede( "search uint64 Equal", n, [&]{
+		bench::consome( graal::search( f, l, s.data(), s.data()+s.size(), 8, igual< std::uint64_t > ) ); } );
+	bench::mede( "search uint64 bit a bit", n, [&]{
+		bench::consome( graal::search( f, l, s.data(), s.data()+s.size(), 8, graal::bitwise ) ); } );
+
+	for(size_t i = n-32; i < n; ++i)
+		v[i] = 0;
+	std::uint64_t zero = 0;
+	bench::mede( "search_n uint64 Equal", n, [&]{
+		bench::consome( graal::search_n( f, l, 32, &zero, 8, igual< std::uint64_t > ) ); } );
+	bench::mede( "search_n uint64 bit a bit", n, [&]{
+		bench::consome( graal::search_n( f, l, 32, &zero, 8, graal::bitwise ) ); } );
+}
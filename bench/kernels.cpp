@@ -0,0 +1,58 @@
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara graal::reverse (shuffles vetoriais para 1, 2, 4 e 8 bytes, nucleos
+// de tamanho fixo para os demais) com a troca antiga, feita com tres
+// std::memcpy de tamanho conhecido so em execucao.
+
+namespace
+{
+	const size_t N = 1 << 22;
+
+	/// Reverse como era feito antes: tres memcpy com sz em tempo de execucao
+	__attribute__((noinline)) void reverse_memcpy( void *first, void *last, size_t sz )
+	{
+		using byte = unsigned char;
+		byte aux[64];
+		byte *it = (byte*) first;
+		byte *at = (byte*) last - sz;
+
+		while(it<at)
+		{
+			std::memcpy(aux, it, sz);
+			std::memcpy(it, at, sz);
+			std::memcpy(at, aux, sz);
+			it += sz;
+			at -= sz;
+		}
+	}
+
+	template < size_t SZ >
+	void compara( const char *antigo, const char *novo )
+	{
+		std::vector< unsigned char > v( N*SZ, 7 );
+		void *f = v.data();
+		void *l = v.data()+v.size();
+		// sz opaco para o compilador, como nas chamadas reais da biblioteca
+		volatile size_t sz = SZ;
+
+		bench::mede( antigo, N, [&]{ reverse_memcpy( f, l, sz ); bench::consome( v[0] ); } );
+		bench::mede( novo, N, [&]{ graal::reverse( f, l, sz ); bench::consome( v[0] ); } );
+
+		std::vector< unsigned char > d( v.size() );
+		bench::mede( "  reverse_copy", N, [&]{ graal::reverse_copy( f, l, d.data(), sz ); bench::consome( d[0] ); } );
+	}
+}
+
+BENCH(kernels_reverse)
+{
+	compara< 1 >( "reverse sz=1 memcpy(sz)", "reverse sz=1 shuffle" );
+	compara< 2 >( "reverse sz=2 memcpy(sz)", "reverse sz=2 shuffle" );
+	compara< 4 >( "reverse sz=4 memcpy(sz)", "reverse sz=4 shuffle" );
+	compara< 8 >( "reverse sz=8 memcpy(sz)", "reverse sz=8 shuffle" );
+	compara< 24 >( "reverse sz=24 memcpy(sz)", "reverse sz=24 palavras" );
+	compara< 40 >( "reverse sz=40 memcpy(sz)", "reverse sz=40 palavras" );
+}
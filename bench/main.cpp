@@ -0,0 +1,24 @@
+#include <cstring>
+#include "bench.h"
+
+std::vector< std::pair< const char *, bench::Caso > > &bench::casos()
+{
+	static std::vector< std::pair< const char *, Caso > > lista;
+	return lista;
+}
+
+/// Executa todos os casos, ou apenas os que contem argv[1] no nome
+int main( int argc, char **argv )
+{
+	const char *filtro = argc > 1 ? argv[1] : "";
+
+	for(auto &c : bench::casos())
+	{
+		if(std::strstr(c.first, filtro) == nullptr)
+			continue;
+
+		std::printf( "%s\n", c.first );
+		c.second();
+	}
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara min com Compare (ponteiro de funcao por elemento) com os nucleos
+// vetoriais escolhidos por ElementType.
+
+namespace
+{
+	const size_t N = 1 << 24;
+
+	template < typename T >
+	bool menor( const void *a, const void *b )
+	{
+		return *static_cast< const T * >(a) < *static_cast< const T * >(b);
+	}
+
+	template < typename T >
+	void compara( graal::ElementType type, const char *antigo, const char *novo, const char *ambos )
+	{
+		std::vector< T > v( N );
+		std::srand( 7 );
+		for(auto &x : v)
+			x = T( std::rand() % 100 );
+		const T *f = v.data(), *l = v.data()+N;
+
+		bench::mede( antigo, N, [&]{ bench::consome( graal::min( f, l, sizeof(T), menor< T > ) ); } );
+		bench::mede( novo, N, [&]{ bench::consome( graal::min( f, l, sizeof(T), type ) ); } );
+		bench::mede( ambos, N, [&]{ bench::consome( graal::minmax( f, l, sizeof(T), type ) ); } );
+	}
+}
+
+BENCH(minmax_primitivos)
+{
+	compara< std::int32_t >( graal::ElementType::Int32, "min int32 Compare", "min int32 vetorial", "minmax int32 vetorial" );
+	compara< std::uint8_t >( graal::ElementType::UInt8, "min uint8 Compare", "min uint8 vetorial", "minmax uint8 vetorial" );
+	compara< float >( graal::ElementType::Float, "min float Compare", "min float vetorial", "minmax float vetorial" );
+}
+
+namespace
+{
+	bool int_maior( const void *a, const void *b )
+	{
+		return *static_cast< const int * >(a) > *static_cast< const int * >(b);
+	}
+
+	bool int_par( const void *a )
+	{
+		return *static_cast< const int * >(a) % 2 == 0;
+	}
+}
+
+// Menor, maior, primeiro par e all_of em passadas separadas contra uma
+// passada de scan_stats, num intervalo maior que a cache.
+BENCH(scan_stats)
+{
+	const size_t M = 1 << 25;
+	std::vector< int > v( M );
+	std::srand( 11 );
+	for(auto &x : v)
+		x = 2*(std::rand() % 1000000) + 1;
+	v[M-1] = 4;
+	const int *f = v.data(), *l = v.data()+M;
+
+	bench::mede( "4 passadas (min, max, find_if, all_of)", M, [&]{
+		bench::consome( graal::min( f, l, sizeof(int), menor< int > ) );
+		bench::consome( graal::min( f, l, sizeof(int), int_maior ) );
+		bench::consome( graal::find_if( f, l, sizeof(int), int_par ) );
+		bench::consome( graal::all_of( f, l, sizeof(int), int_par ) ); } );
+	bench::mede( "scan_stats (1 passada)", M, [&]{
+		bench::consome( graal::scan_stats( f, l, sizeof(int), graal::ScanSpec( menor< int >, int_par ) ).min ); } );
+}
@@ -0,0 +1,33 @@
+#include <vector>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara as buscas sequenciais com as paralelas em um intervalo grande, com
+// a unica ocorrencia perto do fim. Em uma maquina com um nucleo so as versoes
+// paralelas mostram o custo de criar as threads e dividir o trabalho.
+
+namespace
+{
+	const size_t N = 1 << 26;
+
+	bool int_negativo( const void *a )
+	{
+		return *static_cast< const int * >(a) < 0;
+	}
+}
+
+BENCH(parallel_find)
+{
+	std::vector< int > v( N, 1 );
+	v[N - N/16] = -1;
+	const int *f = v.data(), *l = v.data()+N;
+	int alvo = -1;
+
+	bench::mede( "find_if", N, [&]{ bench::consome( graal::find_if( f, l, sizeof(int), int_negativo ) ); }, 3 );
+	bench::mede( "parallel_find_if", N, [&]{ bench::consome( graal::parallel_find_if( f, l, sizeof(int), int_negativo ) ); }, 3 );
+	bench::mede( "parallel_find_if (4 threads)", N, [&]{ bench::consome( graal::parallel_find_if( f, l, sizeof(int), int_negativo, 4 ) ); }, 3 );
+	bench::mede( "find bit a bit", N, [&]{ bench::consome( graal::find( f, l, sizeof(int), &alvo, graal::bitwise ) ); }, 3 );
+	bench::mede( "parallel_find bit a bit", N, [&]{ bench::consome( graal::parallel_find( f, l, sizeof(int), &alvo, graal::bitwise ) ); }, 3 );
+	bench::mede( "any_of", N, [&]{ bench::consome( graal::any_of( f, l, sizeof(int), int_negativo ) ); }, 3 );
+	bench::mede( "parallel_any_of", N, [&]{ bench::consome( graal::parallel_any_of( f, l, sizeof(int), int_negativo ) ); }, 3 );
+}
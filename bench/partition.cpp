@@ -0,0 +1,92 @@
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara a particao antiga (um desvio por elemento, imprevisivel quando o
+// predicado eh aleatorio) com graal::partition, que avalia o predicado em
+// blocos e guarda sem desvios as posicoes dos verdadeiros. Compara tambem
+// stable_partition com a alternativa de ordenar de forma estavel pelo predicado.
+
+namespace
+{
+	const size_t N = 1 << 22;
+
+	bool int_par( const void *a )
+	{
+		return *static_cast< const int * >(a) % 2 == 0;
+	}
+
+	/// Partition como era feito antes: troca a cada verdadeiro, no mesmo laco da avaliacao
+	__attribute__((noinline)) void *partition_lomuto( void *first, void *last, size_t sz, graal::Predicate p )
+	{
+		using byte = unsigned char;
+		byte *aux = (byte*) first;
+		for(byte *it = (byte*) first; it!=(byte*) last; it += sz)
+		{
+			if(p(it))
+			{
+				if(it!=aux)
+				{
+					int t;
+					std::memcpy(&t, aux, sizeof(int));
+					std::memcpy(aux, it, sizeof(int));
+					std::memcpy(it, &t, sizeof(int));
+				}
+				aux += sz;
+			}
+		}
+		return aux;
+	}
+}
+
+BENCH(partition_blocks)
+{
+	std::vector< int > v( N ), w;
+	std::srand( 7 );
+	for(auto &x : v)
+		x = std::rand();
+
+	// Metade dos elementos eh par, em ordem aleatoria: o pior caso para o preditor
+	bench::mede( "partition antiga", N, [&]{
+		w = v;
+		bench::consome( partition_lomuto( w.data(), w.data()+N, sizeof(int), int_par ) ); } );
+	bench::mede( "graal::partition", N, [&]{
+		w = v;
+		bench::consome( graal::partition( w.data(), w.data()+N, sizeof(int), int_par ) ); } );
+	bench::mede( "graal::partition (tipado)", N, [&]{
+		w = v;
+		bench::consome( graal::partition( w.data(), w.data()+N, []( int a ) { return a % 2 == 0; } ) ); } );
+}
+
+namespace
+{
+	/// Ordem usada para obter uma particao estavel com stable_sort: verdadeiros antes
+	bool par_antes( const void *a, const void *b )
+	{
+		return int_par(a) && !int_par(b);
+	}
+}
+
+BENCH(partition_stable)
+{
+	std::vector< int > v( N ), w;
+	std::srand( 7 );
+	for(auto &x : v)
+		x = std::rand();
+
+	bench::mede( "stable_sort pelo predicado", N, [&]{
+		w = v;
+		graal::stable_sort( w.data(), N, sizeof(int), par_antes ); }, 3 );
+	bench::mede( "stable_partition (buffer)", N, [&]{
+		w = v;
+		bench::consome( graal::stable_partition( w.data(), w.data()+N, sizeof(int), int_par ) ); }, 3 );
+	bench::mede( "stable_partition (64KB)", N, [&]{
+		w = v;
+		bench::consome( graal::stable_partition( w.data(), w.data()+N, sizeof(int), int_par, 64*1024 ) ); }, 3 );
+	bench::mede( "stable_partition (in-place)", N, [&]{
+		w = v;
+		bench::consome( graal::stable_partition( w.data(), w.data()+N, sizeof(int), int_par, 0 ) ); }, 3 );
+}
@@ -0,0 +1,172 @@
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara graal::qsort com o qsort da libc, com a mesma interface
+// void*/count/sz/Compare, em varias distribuicoes de int32, e as variantes
+// radix_sort, parallel_qsort e stable_sort; e qsort de std::string com
+// TypeOps contra std::sort; e, com registros de 256 bytes, qsort direto
+// contra argsort + apply_permutation.
+
+namespace
+{
+	const size_t N = 1 << 20;
+
+	bool menor( const void *a, const void *b )
+	{
+		return *static_cast< const int * >(a) < *static_cast< const int * >(b);
+	}
+
+	int compara_libc( const void *a, const void *b )
+	{
+		int x = *static_cast< const int * >(a);
+		int y = *static_cast< const int * >(b);
+		return (x > y) - (x < y);
+	}
+
+	std::vector< int > gera( int tipo )
+	{
+		std::vector< int > v( N );
+		std::srand( 1 );
+		for(size_t i = 0; i < N; ++i)
+		{
+			switch(tipo)
+			{
+				case 0: v[i] = std::rand(); break;          // aleatorio
+				case 1: v[i] = (int) i; break;              // ordenado
+				case 2: v[i] = (int) (N-i); break;          // invertido
+				case 3: v[i] = std::rand() % 16; break;     // muitos repetidos
+				case 4: v[i] = (int) (i < N/2 ? i : N-i); break; // organ pipe
+				case 5: v[i] = i % 1000 == 0 ? std::rand() : (int) i; break; // quase ordenado
+				case 6: v[i] = (int) (i % (N/4)); break;    // 4 dentes de serra
+			}
+		}
+		return v;
+	}
+
+	const char *nomes[] = { "aleatorio", "ordenado", "invertido", "16 valores", "organ pipe", "quase ordenado",
+			"dentes de serra" };
+	const int TIPOS = sizeof(nomes) / sizeof(nomes[0]);
+}
+
+BENCH(sort_qsort)
+{
+	for(int tipo = 0; tipo < TIPOS; ++tipo)
+	{
+		std::vector< int > base = gera( tipo ), v;
+		std::printf( " %s\n", nomes[tipo] );
+
+		double libc = bench::mede( "libc qsort", N, [&]{ v = base; ::qsort( v.data(), N, sizeof(int), compara_libc ); }, 3 );
+		double graal = bench::mede( "graal::qsort", N, [&]{ v = base; graal::qsort( v.data(), N, sizeof(int), menor ); }, 3 );
+
+		// graal::qsort deve vencer a libc em todas as distribuicoes, organ pipe inclusive
+		if(graal >= libc)
+			std::printf( "  ** graal::qsort perdeu para a libc em %s\n", nomes[tipo] );
+	}
+}
+
+BENCH(sort_radix)
+{
+	std::vector< int > base = gera( 0 ), v, scratch( N );
+	for(auto &x : base)
+		x -= RAND_MAX/2;
+
+	bench::mede( "graal::qsort int32", N, [&]{ v = base; graal::qsort( v.data(), N, sizeof(int), menor ); }, 3 );
+	bench::mede( "graal::radix_sort int32", N, [&]{
+		v = base;
+		graal::radix_sort( v.data(), N, sizeof(int), graal::Key( 0, graal::ElementType::Int32 ), scratch.data() ); }, 3 );
+
+	// So os 16 bits baixos variam: duas passadas sao puladas
+	for(auto &x : base)
+		x &= 0xffff;
+	bench::mede( "graal::radix_sort int32 (16 bits)", N, [&]{
+		v = base;
+		graal::radix_sort( v.data(), N, sizeof(int), graal::Key( 0, graal::ElementType::Int32 ), scratch.data() ); }, 3 );
+}
+
+BENCH(sort_parallel)
+{
+	// Aleatorio e muitos repetidos, que usam os baldes de igualdade
+	for(int tipo : { 0, 3 })
+	{
+		std::vector< int > base = gera( tipo ), v;
+		std::printf( " %s\n", nomes[tipo] );
+
+		bench::mede( "graal::qsort", N, [&]{ v = base; graal::qsort( v.data(), N, sizeof(int), menor ); }, 3 );
+		bench::mede( "graal::parallel_qsort", N, [&]{ v = base; graal::parallel_qsort( v.data(), N, sizeof(int), menor ); }, 3 );
+		bench::mede( "graal::parallel_qsort (4 threads)", N, [&]{ v = base; graal::parallel_qsort( v.data(), N, sizeof(int), menor, 4 ); }, 3 );
+	}
+}
+
+BENCH(sort_stable)
+{
+	for(int tipo = 0; tipo < TIPOS; ++tipo)
+	{
+		std::vector< int > base = gera( tipo ), v;
+		std::printf( " %s\n", nomes[tipo] );
+
+		bench::mede( "std::stable_sort", N, [&]{ v = base; std::stable_sort( v.begin(), v.end() ); }, 3 );
+		bench::mede( "graal::qsort", N, [&]{ v = base; graal::qsort( v.data(), N, sizeof(int), menor ); }, 3 );
+		bench::mede( "graal::stable_sort", N, [&]{ v = base; graal::stable_sort( v.data(), N, sizeof(int), menor ); }, 3 );
+	}
+}
+
+namespace
+{
+	bool string_menor( const void *a, const void *b )
+	{
+		return *static_cast< const std::string * >(a) < *static_cast< const std::string * >(b);
+	}
+}
+
+BENCH(sort_typeops)
+{
+	const size_t n = N/8;
+	std::vector< std::string > base( n ), v;
+	std::srand( 4 );
+	for(auto &s : base)
+		s = "chave longa o bastante para o heap " + std::to_string( std::rand() );
+
+	bench::mede( "std::sort std::string", n, [&]{ v = base; std::sort( v.begin(), v.end() ); }, 3 );
+	bench::mede( "graal::qsort std::string (TypeOps)", n, [&]{
+		v = base;
+		graal::qsort( v.data(), n, sizeof(std::string), string_menor, graal::type_ops< std::string >() ); }, 3 );
+}
+
+// Registros de 256 bytes: qsort direto (cada troca move o registro inteiro)
+// contra argsort dos indices seguido de apply_permutation.
+namespace
+{
+	struct Largo
+	{
+		int chave;
+		char resto[ 252 ];
+	};
+
+	bool largo_menor( const void *a, const void *b )
+	{
+		return static_cast< const Largo * >(a)->chave < static_cast< const Largo * >(b)->chave;
+	}
+}
+
+BENCH(sort_argsort)
+{
+	const size_t n = N/16;
+	std::vector< Largo > base( n ), v;
+	std::vector< std::uint32_t > idx( n );
+	std::srand( 5 );
+	for(auto &r : base)
+		r.chave = std::rand();
+
+	bench::mede( "graal::qsort 256 bytes", n, [&]{
+		v = base;
+		graal::qsort( v.data(), n, sizeof(Largo), largo_menor ); }, 3 );
+	bench::mede( "graal::argsort + apply_permutation 256 bytes", n, [&]{
+		v = base;
+		graal::argsort( v.data(), n, sizeof(Largo), largo_menor, idx.data() );
+		graal::apply_permutation( v.data(), n, sizeof(Largo), idx.data() ); }, 3 );
+}
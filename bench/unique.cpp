@@ -0,0 +1,71 @@
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include "bench.h"
+#include "../include/graal.h"
+
+// Compara unique so com Equal (cada elemento contra todos os ja mantidos) com
+// as versoes por tabela de hash: com funcao de hash do usuario, bit a bit e
+// bit a bit com limite de memoria. Com limite, o tempo depende de quantas
+// passadas os valores distintos exigem: de uma (1M valores em 16MB) a dezenas
+// (4M valores em 1MB).
+
+namespace
+{
+	bool igual( const void *a, const void *b )
+	{
+		return *static_cast< const int * >(a) == *static_cast< const int * >(b);
+	}
+
+	size_t hash( const void *a )
+	{
+		return static_cast< size_t >( *static_cast< const int * >(a) );
+	}
+
+	std::vector< int > gera( size_t n, int distintos )
+	{
+		std::vector< int > v( n );
+		std::srand( 1 );
+		for(auto &x : v)
+			x = std::rand() % distintos;
+		return v;
+	}
+}
+
+BENCH(unique_hash)
+{
+	// Poucos valores distintos: a versao quadratica ainda eh viavel
+	{
+		const size_t n = 1 << 16;
+		std::vector< int > base = gera( n, 1000 ), v;
+		std::printf( " 1000 valores distintos\n" );
+		bench::mede( "unique Equal", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), igual ) ); }, 3 );
+		bench::mede( "unique Hash+Equal", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), hash, igual ) ); }, 3 );
+		bench::mede( "unique bit a bit", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise ) ); }, 3 );
+	}
+
+	{
+		const size_t n = 1 << 22;
+		std::vector< int > base = gera( n, 1 << 20 ), v;
+		std::printf( " 1M valores distintos\n" );
+		bench::mede( "unique Hash+Equal", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), hash, igual ) ); }, 3 );
+		bench::mede( "unique bit a bit", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise ) ); }, 3 );
+
+		// Tabela inteira: 64MB; com menos o hash eh dividido em faixas, cada uma com sua tabela
+		bench::mede( "unique Hash+Equal (16MB)", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), hash, igual, 16 << 20 ) ); }, 3 );
+		bench::mede( "unique bit a bit (16MB)", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise, 16 << 20 ) ); }, 3 );
+		bench::mede( "unique bit a bit (4MB)", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise, 4 << 20 ) ); }, 3 );
+		bench::mede( "unique bit a bit (1MB)", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise, 1 << 20 ) ); }, 3 );
+	}
+
+	// Quase todos distintos: o pior caso do limite de memoria
+	{
+		const size_t n = 1 << 22;
+		std::vector< int > base = gera( n, RAND_MAX ), v;
+		std::printf( " 4M valores quase todos distintos\n" );
+		bench::mede( "unique bit a bit", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise ) ); }, 3 );
+		bench::mede( "unique bit a bit (16MB)", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise, 16 << 20 ) ); }, 3 );
+		bench::mede( "unique bit a bit (4MB)", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise, 4 << 20 ) ); }, 3 );
+		bench::mede( "unique bit a bit (1MB)", n, [&]{ v = base; bench::consome( graal::unique( v.data(), v.data()+n, sizeof(int), graal::bitwise, 1 << 20 ) ); }, 3 );
+	}
+}
@@ -1,9 +1,13 @@
-#ifndef GRAAl
+#ifndef GRAAL
 #define GRAAL
 
 #include <iostream>
 #include <iterator> 
 #include <cstring>
+#include <cstdint>
+#include <utility>
+#include <new>
+#include <vector>
 
 namespace graal
 {
@@ -11,6 +15,21 @@ namespace graal
 	using Compare = bool (*)(const void *, const void *);
 	using Predicate = bool (*)(const void *);
 	using Equal = bool (*)(const void *, const void *);
+	using Hash = size_t (*)(const void *);
+
+	// Predicado em lote: avalia os n elementos de sz bytes a partir de block,
+	// escreve em out[i] um valor diferente de 0 se o i-esimo satisfaz o
+	// predicado (0 se nao) e retorna quantos satisfazem. Troca uma chamada
+	// indireta por elemento por uma a cada lote de ate BATCH_SIZE elementos e
+	// permite que quem escreve o predicado o vetorize.
+	using BatchPredicate = size_t (*)(const void *block, size_t n, size_t sz, std::uint8_t *out);
+	const size_t BATCH_SIZE = 256;
+
+	// Marcador usado no lugar de Equal quando dois elementos sao iguais se, e
+	// somente se, seus sz bytes forem iguais (inteiros, enums, ponteiros, structs
+	// sem padding). Permite que a biblioteca compare sem chamar uma funcao.
+	struct Bitwise {};
+	const Bitwise bitwise{};
 
 	/* first, last: intervalo de elementos para analisar;
 	 * sz: tamanho em bytes de cada elemento do array;
@@ -18,22 +37,240 @@ namespace graal
 	 */
 	const void *min( const void *first, const void *last, size_t sz, Compare cmp );
 
+	// Tipos primitivos que a biblioteca sabe comparar sem chamar uma funcao
+	enum class ElementType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Float, Double };
+
+	// Tamanho em bytes de um elemento do tipo type
+	inline size_t element_size( ElementType type )
+	{
+		switch(type)
+		{
+			case ElementType::Int8:   case ElementType::UInt8:  return 1;
+			case ElementType::Int16:  case ElementType::UInt16: return 2;
+			case ElementType::Int32:  case ElementType::UInt32: case ElementType::Float:  return 4;
+			case ElementType::Int64:  case ElementType::UInt64: case ElementType::Double: return 8;
+		}
+		return 0;
+	}
+
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array; deve ser element_size(type),
+	 * senao lanca std::invalid_argument;
+	 * type: tipo dos elementos; a busca usa nucleos vetoriais (SSE2/AVX2);
+	 * Retorna a primeira ocorrencia do menor elemento, ou last se o intervalo for vazio.
+	 * Float/Double: elementos NaN sao ignorados; se todos forem NaN retorna first.
+	 * -0.0 e +0.0 sao iguais, entao vale o que aparecer primeiro.
+	 */
+	const void *min( const void *first, const void *last, size_t sz, ElementType type );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array (element_size(type), como em min);
+	 * type: tipo dos elementos;
+	 * Retorna a primeira ocorrencia do maior elemento, com as mesmas regras de min.
+	 */
+	const void *max( const void *first, const void *last, size_t sz, ElementType type );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array (element_size(type), como em min);
+	 * type: tipo dos elementos;
+	 * Retorna (min, max) calculados em uma unica passada, ambos primeira ocorrencia.
+	 */
+	std::pair< const void *, const void * > minmax( const void *first, const void *last,
+			size_t sz, ElementType type );
+
+	// Descreve o que scan_stats calcula. Com cmp nulo o menor e o maior nao
+	// sao calculados; com pred nulo a contagem e as ocorrencias tambem nao.
+	struct ScanSpec
+	{
+		Compare cmp;
+		Predicate pred;
+		bool last_max;    // true: ultima ocorrencia do maior, como std::minmax_element
+
+		ScanSpec( Compare cmp, Predicate pred = nullptr, bool last_max = false )
+			: cmp( cmp ), pred( pred ), last_max( last_max ) {}
+	};
+
+	// Resultado de scan_stats. Ponteiros que nao foram calculados, ou que nao
+	// existem (intervalo vazio, nenhum elemento com pred verdadeiro), valem last.
+	struct ScanStats
+	{
+		const void *min;            // primeira ocorrencia do menor
+		const void *max;            // primeira (ou ultima) ocorrencia do maior
+		const void *first_match;    // primeiro elemento com pred verdadeiro
+		const void *last_match;     // ultimo elemento com pred verdadeiro
+		size_t count;               // elementos com pred verdadeiro
+		size_t size;                // elementos no intervalo
+
+		bool any_of() const { return count > 0; }
+		bool all_of() const { return count == size; }
+		bool none_of() const { return count == 0; }
+	};
+
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * spec: o que calcular;
+	 * Calcula em uma unica passada o que min, max, count_if, find_if e os
+	 * quantificadores calculariam em passadas separadas. Cada elemento eh lido
+	 * uma vez; cmp eh chamado no maximo duas vezes e pred uma vez por elemento.
+	 */
+	ScanStats scan_stats( const void *first, const void *last, size_t sz, const ScanSpec &spec );
+
 	/* first, last: intervalo de elementos para analisar;
 	 * sz: tamanho em bytes de cada elemento do array; 
+	 * Nao aloca memoria. Retorna last.
 	 */
 	void *reverse( void *first, void *last, size_t sz );
 
+	/* first, last: intervalo de elementos para analisar;
+	 * d_first: inicio do destino, que nao pode se sobrepor a origem;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * Escreve os elementos em ordem inversa em uma unica passada.
+	 * Retorna o ponteiro para o endereco apos o ultimo elemento escrito.
+	 */
+	void *reverse_copy( const void *first, const void *last, void *d_first, size_t sz );
+
+	// Como copy, copy_backward e move escrevem no destino. Auto usa stores nao
+	// temporais (que nao poluem a cache) so quando o intervalo passa do tamanho
+	// da maior cache; Cached e Streaming forcam um dos dois caminhos.
+	enum class CopyMode { Auto, Cached, Streaming };
+
 	/* fisrt, last: intervalo de elementos para analisar;
 	 * sz: tamanho em bytes de cada elemento do array 
 	 * d_first: poteiro que indica a nova posicao para fazer a colagem dos elementos 
+	 * mode: como escrever no destino (veja CopyMode);
+	 * O intervalo eh copiado de uma so vez, e nao elemento a elemento.
+	 * Retorna o ponteiro para o endereco apos o ultimo elemento copiado.
 	 */
-	void *copy( const void *first, const void *last, const void *d_first, size_t sz );
+	void *copy( const void *first, const void *last, const void *d_first, size_t sz,
+			CopyMode mode = CopyMode::Auto );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * d_last: ponteiro para o endereco apos o ultimo elemento do destino;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * mode: como escrever no destino (veja CopyMode);
+	 * Copia do ultimo para o primeiro elemento, entao o destino pode se sobrepor
+	 * ao final da origem. Retorna o inicio do destino.
+	 */
+	void *copy_backward( const void *first, const void *last, void *d_last, size_t sz,
+			CopyMode mode = CopyMode::Auto );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * d_first: inicio do destino, que pode se sobrepor a origem em qualquer sentido;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * mode: como escrever no destino (veja CopyMode);
+	 * Retorna o ponteiro para o endereco apos o ultimo elemento movido.
+	 */
+	void *move( const void *first, const void *last, void *d_first, size_t sz,
+			CopyMode mode = CopyMode::Auto );
+
+	// ------------------------------------------------------------------------
+	//  Memoria para clone e para os algoritmos que precisam de espaco auxiliar
+	// ------------------------------------------------------------------------
+
+	// Alinhamento padrao dos buffers: uma linha de cache
+	const size_t CACHE_LINE = 64;
+
+	// Interface dos alocadores aceitos pela biblioteca. clone e os algoritmos
+	// com memoria auxiliar (radix_sort, stable_sort, stable_partition, unique,
+	// parallel_qsort, apply_permutation) recebem um; o padrao eh
+	// default_allocator().
+	class Allocator
+	{
+		public:
+			virtual ~Allocator() {}
+
+			/// Reserva bytes alinhados em align (potencia de 2); lanca std::bad_alloc se falhar
+			virtual void *allocate( size_t bytes, size_t align ) = 0;
+
+			/// Devolve um bloco obtido com allocate
+			virtual void deallocate( void *p, size_t bytes ) = 0;
+	};
+
+	/// Alocador que usa o heap do sistema
+	Allocator &default_allocator();
+
+	// Alocador por incremento de ponteiro (bump). Cada allocate apenas avanca
+	// um deslocamento dentro de blocos grandes; deallocate nao faz nada e toda
+	// a memoria volta a ficar livre com reset(), sem devolver os blocos.
+	// Buffers obtidos de uma Arena so valem ate o proximo reset().
+	class Arena : public Allocator
+	{
+		public:
+			/* block: tamanho minimo de cada bloco pedido ao upstream;
+			 * upstream: de onde vem os blocos;
+			 */
+			explicit Arena( size_t block = 64*1024, Allocator &upstream = default_allocator() );
+			~Arena();
+
+			Arena( const Arena & ) = delete;
+			Arena &operator=( const Arena & ) = delete;
+
+			void *allocate( size_t bytes, size_t align ) override;
+			void deallocate( void *, size_t ) override {}
+
+			/// Libera tudo o que foi alocado, mantendo os blocos para reuso
+			void reset();
+
+			/// Bytes alocados desde o ultimo reset
+			size_t used() const;
+
+			/// Arena propria da thread que chama
+			static Arena &local();
+
+		private:
+			struct Bloco { void *inicio; size_t tamanho; };
+
+			Allocator &m_upstream;
+			size_t m_block;
+			std::vector< Bloco > m_blocos;
+			size_t m_atual;
+			size_t m_ocupado;
+			size_t m_usado;
+	};
+
+	// Buffer dono da sua memoria: libera no destrutor e so pode ser movido.
+	class Buffer
+	{
+		public:
+			Buffer() : m_data( nullptr ), m_size( 0 ), m_alloc( nullptr ) {}
+
+			/* alloc: alocador de onde vem (e para onde volta) a memoria;
+			 * bytes: tamanho do buffer, alinhado em CACHE_LINE;
+			 */
+			Buffer( Allocator &alloc, size_t bytes );
+			~Buffer();
+
+			Buffer( Buffer &&o );
+			Buffer &operator=( Buffer &&o );
+			Buffer( const Buffer & ) = delete;
+			Buffer &operator=( const Buffer & ) = delete;
+
+			void *data() const { return m_data; }
+			size_t size() const { return m_size; }
+			explicit operator bool() const { return m_data != nullptr; }
+
+			template < typename T >
+			T *as() const { return static_cast< T * >(m_data); }
+
+		private:
+			void *m_data;
+			size_t m_size;
+			Allocator *m_alloc;
+	};
 
 	/* first, last: intervalo de elementos para analisar;
 	 * sz: tamanho em bytes de cada elemento do array; 
+	 * Retorna o inicio do novo array, que deve ser liberado com delete[].
 	 */
 	void *clone( const void *first, const void *last, size_t sz );
 
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * alloc: alocador usado para a copia (por exemplo uma Arena);
+	 * Retorna um Buffer com a copia, alinhado em CACHE_LINE.
+	 */
+	Buffer clone( const void *first, const void *last, size_t sz, Allocator &alloc );
+
 	/* first, last: intervalo de elementos para analisar;
 	 * sz: tamanho em bytes de cada elemento do array;
 	 * p: predicado unário que retorna verdadeiro para o elemento requerido;
@@ -48,6 +285,16 @@ namespace graal
 	const void *find( const void *first, const void *last, size_t sz,
 			const void *value, Equal eq );
 
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * value: valor para comparar os elementos;
+	 * graal::bitwise: compara os sz bytes de cada elemento com os de value. Para
+	 * sz = 1, 2, 4 e 8 a busca usa comparacoes vetoriais (SSE2/AVX2); para os
+	 * demais tamanhos, memcmp. Retorna a primeira ocorrencia, ou last.
+	 */
+	const void *find( const void *first, const void *last, size_t sz,
+			const void *value, Bitwise );
+
 	/* first, last: intervalo de elementos para analisar;
 	 * sz: tamanho em bytes de cada elemento do array;
 	 * p: predicado unário que retorna verdadeiro para o elemento requerido;
@@ -66,16 +313,633 @@ namespace graal
 	 */
 	bool none_of( const void *first, const void *last, size_t sz, Predicate p );
 
-	// TODO: equal
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * p: predicado em lote (veja BatchPredicate);
+	 * Versoes de find_if, all_of, any_of e none_of que avaliam o intervalo em
+	 * lotes. Lotes em que a contagem retornada ja decide nao tem a mascara lida.
+	 */
+	const void *find_if( const void *first, const void *last, size_t sz, BatchPredicate p );
+	bool all_of( const void *first, const void *last, size_t sz, BatchPredicate p );
+	bool any_of( const void *first, const void *last, size_t sz, BatchPredicate p );
+	bool none_of( const void *first, const void *last, size_t sz, BatchPredicate p );
+
+	// Abaixo desta quantidade de elementos as buscas paralelas usam uma thread so
+	const size_t PARALLEL_FIND_THRESHOLD = 1 << 18;
+
+	/* first, last, sz, p: como em find_if;
+	 * threads: quantidade de threads; 0 usa o numero de nucleos da maquina;
+	 * threshold: abaixo desta quantidade de elementos a busca eh sequencial;
+	 * As threads percorrem pedacos do intervalo em ordem crescente e param
+	 * assim que uma ocorrencia anterior ao pedaco for conhecida. Retorna a
+	 * primeira ocorrencia, exatamente como find_if.
+	 */
+	const void *parallel_find_if( const void *first, const void *last, size_t sz, Predicate p,
+			unsigned threads = 0, size_t threshold = PARALLEL_FIND_THRESHOLD );
+
+	/// find com Equal em paralelo, como parallel_find_if
+	const void *parallel_find( const void *first, const void *last, size_t sz,
+			const void *value, Equal eq,
+			unsigned threads = 0, size_t threshold = PARALLEL_FIND_THRESHOLD );
+
+	/// find bit a bit em paralelo, como parallel_find_if
+	const void *parallel_find( const void *first, const void *last, size_t sz,
+			const void *value, Bitwise,
+			unsigned threads = 0, size_t threshold = PARALLEL_FIND_THRESHOLD );
+
+	/* first, last, sz, p: como em any_of, all_of e none_of;
+	 * threads, threshold: como em parallel_find_if;
+	 * Todas as threads param assim que a resposta for conhecida (o primeiro
+	 * verdadeiro em any_of e none_of, o primeiro falso em all_of).
+	 */
+	bool parallel_any_of( const void *first, const void *last, size_t sz, Predicate p,
+			unsigned threads = 0, size_t threshold = PARALLEL_FIND_THRESHOLD );
+	bool parallel_all_of( const void *first, const void *last, size_t sz, Predicate p,
+			unsigned threads = 0, size_t threshold = PARALLEL_FIND_THRESHOLD );
+	bool parallel_none_of( const void *first, const void *last, size_t sz, Predicate p,
+			unsigned threads = 0, size_t threshold = PARALLEL_FIND_THRESHOLD );
+
+	/* first1, last1: primeiro intervalo;
+	 * first2: inicio do segundo intervalo, com pelo menos last1-first1 bytes;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * eq: funcao binária que retorna true se os elementos forem iguais;
+	 * Retorna true se os elementos correspondentes forem todos iguais.
+	 */
+	bool equal( const void *first1, const void *last1, const void *first2, size_t sz, Equal eq );
+
+	/* first2, last2: segundo intervalo; demais parametros como acima;
+	 * Intervalos de tamanhos diferentes retornam false sem comparar nada.
+	 */
+	bool equal( const void *first1, const void *last1, const void *first2, const void *last2,
+			size_t sz, Equal eq );
+
+	/* Como os equal acima, comparando os bytes dos intervalos inteiros de uma
+	 * vez com memcmp (vetorizado), sem chamar uma funcao por elemento.
+	 */
+	bool equal( const void *first1, const void *last1, const void *first2, size_t sz, Bitwise );
+	bool equal( const void *first1, const void *last1, const void *first2, const void *last2,
+			size_t sz, Bitwise );
+
+	/* first1, last1, first2, sz, eq: como em equal;
+	 * Retorna o primeiro par de elementos correspondentes diferentes, ou
+	 * (last1, first2 + (last1-first1)) se nao houver diferenca.
+	 */
+	std::pair< const void *, const void * > mismatch( const void *first1, const void *last1,
+			const void *first2, size_t sz, Equal eq );
+
+	/* first2, last2: segundo intervalo; a comparacao para no fim do menor;
+	 * Se nao houver diferenca, retorna o fim do menor intervalo e a posicao
+	 * correspondente no outro.
+	 */
+	std::pair< const void *, const void * > mismatch( const void *first1, const void *last1,
+			const void *first2, const void *last2, size_t sz, Equal eq );
+
+	/* Como os mismatch acima, comparando bytes com SSE2/AVX2; o par retornado
+	 * aponta para o inicio dos elementos que contem o primeiro byte diferente.
+	 */
+	std::pair< const void *, const void * > mismatch( const void *first1, const void *last1,
+			const void *first2, size_t sz, Bitwise );
+	std::pair< const void *, const void * > mismatch( const void *first1, const void *last1,
+			const void *first2, const void *last2, size_t sz, Bitwise );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * s_first, s_last: sequencia procurada;
+	 * sz: tamanho em bytes de cada elemento dos dois intervalos;
+	 * eq: funcao binária que retorna true se os elementos forem iguais;
+	 * Retorna o inicio da primeira ocorrencia da sequencia, first se ela for
+	 * vazia ou last se nao houver. Testa cada posicao: O(n*m) no pior caso.
+	 */
+	const void *search( const void *first, const void *last, const void *s_first, const void *s_last,
+			size_t sz, Equal eq );
+
+	/* Como o search acima, comparando bytes. Usa Horspool com uma tabela de
+	 * saltos indexada pelos bytes dos elementos: tipicamente olha cerca de n/m
+	 * elementos do intervalo.
+	 */
+	const void *search( const void *first, const void *last, const void *s_first, const void *s_last,
+			size_t sz, Bitwise );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * count: tamanho da sequencia procurada;
+	 * value: valor que se repete na sequencia;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * eq: funcao binária que retorna true se os elementos forem iguais;
+	 * Retorna o inicio da primeira sequencia de count elementos iguais a value,
+	 * first se count for 0 ou last se nao houver. Cada elemento eh comparado no
+	 * maximo uma vez, e um elemento diferente faz a busca pular count posicoes.
+	 */
+	const void *search_n( const void *first, const void *last, size_t count, const void *value,
+			size_t sz, Equal eq );
+
+	/// search_n comparando bytes
+	const void *search_n( const void *first, const void *last, size_t count, const void *value,
+			size_t sz, Bitwise );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * eq: funcao binária que retorna true se os elementos forem iguais;
+	 * Remove todas as repeticoes do intervalo (nao so as vizinhas), mantendo a
+	 * primeira ocorrencia de cada valor na ordem original. Sem hash cada
+	 * elemento eh comparado com todos os ja mantidos: O(n*k), com k valores
+	 * distintos. Retorna o fim do intervalo sem repeticoes.
+	 */
+	void *unique( void *first, void *last, size_t sz, Equal eq );
+
+	/* first, last, sz, eq: como acima;
+	 * hash: funcao que retorna o hash de um elemento; elementos iguais para eq
+	 * devem ter o mesmo hash;
+	 * alloc: alocador da tabela de hash;
+	 * Com o alocador padrao usa uma tabela por thread, reaproveitada entre
+	 * chamadas e mantida ate unique_release_scratch; com outro, aloca a
+	 * tabela de alloc a cada chamada. O(n) esperado.
+	 */
+	void *unique( void *first, void *last, size_t sz, Hash hash, Equal eq,
+			Allocator &alloc = default_allocator() );
+
+	/* first, last, sz, hash, eq: como acima;
+	 * max_memory: maximo de bytes de memoria auxiliar;
+	 * Se a tabela para o intervalo inteiro nao couber, um bit por elemento
+	 * guarda os mantidos e o resto da memoria comporta C entradas de 8 bytes
+	 * (16 com 2^32 elementos ou mais), divididas em tabelas de hash por
+	 * faixas do hash. Se os D valores distintos couberem em 15/16 delas basta
+	 * uma passada, com uma chamada de hash por elemento; senao as faixas que
+	 * nao couberem ficam para as passadas seguintes, cerca de D/(7/8*C) no
+	 * total. O resultado eh o mesmo do unique sem limite.
+	 * O minimo eh (n+63)/64*8 bytes do mapa mais 16 entradas; com menos (e a
+	 * tabela inteira sem caber) lanca std::invalid_argument.
+	 * alloc: alocador da memoria auxiliar, como acima;
+	 */
+	void *unique( void *first, void *last, size_t sz, Hash hash, Equal eq, size_t max_memory,
+			Allocator &alloc = default_allocator() );
+
+	/* first, last, sz: como acima;
+	 * graal::bitwise: elementos sao iguais se seus sz bytes forem iguais; o
+	 * hash dos bytes eh feito pela biblioteca. Elementos de 1 e 2 bytes usam
+	 * um mapa de bits em vez da tabela de hash.
+	 * alloc: alocador da memoria auxiliar, como no unique com hash;
+	 */
+	void *unique( void *first, void *last, size_t sz, Bitwise, Allocator &alloc = default_allocator() );
+
+	/* first, last, sz, graal::bitwise, alloc: como acima;
+	 * max_memory: maximo de bytes de memoria auxiliar, como no unique com hash;
+	 */
+	void *unique( void *first, void *last, size_t sz, Bitwise, size_t max_memory,
+			Allocator &alloc = default_allocator() );
+
+	/* Libera a tabela de hash que unique (com o alocador padrao) mantem na
+	 * thread que chama. A tabela cresce ate o maior intervalo ja tratado
+	 * pela thread; a proxima chamada aloca outra.
+	 */
+	void unique_release_scratch();
 
-	// TODO: unique
-	
 	/* first, last: intervalo de elementos para analisar;
 	 * sz: tamanho em bytes de cada elemento do array;
 	 * p: predicado unário que retorna verdadeiro para o elemento requerido;
 	 */
 	void *partition( void *first, void *last, size_t sz, Predicate p );
 
-	// TODO: sort
+	/* first, last, sz: como acima;
+	 * p: predicado em lote (veja BatchPredicate);
+	 * Mesmo resultado de partition com o predicado equivalente.
+	 */
+	void *partition( void *first, void *last, size_t sz, BatchPredicate p );
+
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * p: predicado unário que retorna verdadeiro para o elemento requerido;
+	 * max_scratch: maximo de bytes de memoria auxiliar;
+	 * Como partition, mas os dois grupos mantem a ordem original. Com buffer
+	 * para os falsos basta uma passada; com menos (ou max_scratch = 0) o
+	 * intervalo eh dividido e os pedacos juntados por rotacoes, em O(n log n).
+	 * p eh chamado uma vez por elemento. Retorna o inicio do grupo dos falsos.
+	 * alloc: alocador do buffer;
+	 */
+	void *stable_partition( void *first, void *last, size_t sz, Predicate p, size_t max_scratch = SIZE_MAX,
+			Allocator &alloc = default_allocator() );
+
+	/* first: inicio do array a ser ordenado;
+	 * count: quantidade de elementos;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * cmp: funcao binaria que retorna true se o primeiro elemento for menor que o segundo;
+	 * Usa pattern-defeating quicksort: O(n log n) no pior caso, linear em
+	 * entradas ja ordenadas ou invertidas. Entradas formadas por sequencias
+	 * ordenadas longas (como organ pipe ou quase ordenadas) sao fundidas
+	 * como em stable_sort, com um buffer de ate count/2 elementos do heap.
+	 * Nao eh estavel.
+	 */
+	void qsort( void *first, size_t count, size_t sz, Compare cmp );
+
+	// Abaixo desta quantidade de elementos parallel_qsort usa apenas qsort
+	const size_t PARALLEL_SORT_THRESHOLD = 1 << 17;
+
+	/* first, count, sz, cmp: como em qsort;
+	 * threads: quantidade de threads; 0 usa o numero de nucleos da maquina;
+	 * threshold: abaixo desta quantidade de elementos a ordenacao eh sequencial;
+	 * Sample sort paralelo: os elementos sao distribuidos em baldes por
+	 * separadores amostrados e cada balde eh ordenado com qsort em paralelo.
+	 * Um valor muito repetido fica em um balde proprio, que nao eh ordenado.
+	 * Usa count*(sz+1) bytes de memoria auxiliar. Nao eh estavel. Uma
+	 * excecao de cmp ou da alocacao em qualquer thread eh relancada na thread
+	 * que chama, e o conteudo do intervalo fica indefinido.
+	 * alloc: alocador da memoria auxiliar; so eh usado pela thread que chama
+	 * (os temporarios de um elemento das outras threads vem do heap);
+	 */
+	void parallel_qsort( void *first, size_t count, size_t sz, Compare cmp,
+			unsigned threads = 0, size_t threshold = PARALLEL_SORT_THRESHOLD,
+			Allocator &alloc = default_allocator() );
+
+	/* first, count, sz, cmp: como em qsort;
+	 * max_scratch: maximo de bytes de memoria auxiliar para as fusoes;
+	 * Ordenacao estavel adaptativa: aproveita sequencias ja ordenadas (ou
+	 * estritamente decrescentes) e as funde com galloping, ficando quase
+	 * linear em entradas pre-ordenadas. Com menos memoria que o necessario as
+	 * fusoes grandes sao feitas por rotacoes, mais lentas, sem alocar alem
+	 * de max_scratch (elementos de mais de 256 bytes alocam ainda um
+	 * temporario de um elemento).
+	 * alloc: alocador da memoria auxiliar;
+	 * Retorna a quantidade de bytes de memoria auxiliar alocada.
+	 */
+	size_t stable_sort( void *first, size_t count, size_t sz, Compare cmp, size_t max_scratch = SIZE_MAX,
+			Allocator &alloc = default_allocator() );
+
+	/* first, last: intervalo ordenado segundo cmp (como deixado por qsort);
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * value: valor procurado;
+	 * cmp: funcao binaria que retorna true se o primeiro elemento for menor que o segundo;
+	 * Retorna o primeiro elemento que nao eh menor que value, ou last.
+	 * Busca binaria sem desvios: sempre cerca de log2(n) + 1 chamadas a cmp,
+	 * com prefetch dos dois pontos medios possiveis da iteracao seguinte.
+	 */
+	const void *lower_bound( const void *first, const void *last, size_t sz,
+			const void *value, Compare cmp );
+
+	/// Como lower_bound, mas retorna o primeiro elemento maior que value, ou last
+	const void *upper_bound( const void *first, const void *last, size_t sz,
+			const void *value, Compare cmp );
+
+	/// Retorna (lower_bound, upper_bound): os elementos equivalentes a value
+	std::pair< const void *, const void * > equal_range( const void *first, const void *last,
+			size_t sz, const void *value, Compare cmp );
+
+	/// Retorna true se algum elemento for equivalente a value
+	bool binary_search( const void *first, const void *last, size_t sz,
+			const void *value, Compare cmp );
+
+	/* first, last, sz, cmp: como em lower_bound;
+	 * keys: count chaves de sz bytes cada, em qualquer ordem;
+	 * out: recebe, para cada chave, o indice do seu lower_bound em [first, last);
+	 * As buscas sao feitas em grupos de 16, uma iteracao de cada por vez, e
+	 * o proximo elemento lido por cada uma recebe prefetch enquanto as outras
+	 * avancam: as faltas de cache do grupo acontecem em paralelo.
+	 */
+	void batch_lower_bound( const void *first, const void *last, size_t sz,
+			const void *keys, size_t count, size_t *out, Compare cmp );
+
+	/// Como batch_lower_bound, com o indice do upper_bound de cada chave
+	void batch_upper_bound( const void *first, const void *last, size_t sz,
+			const void *keys, size_t count, size_t *out, Compare cmp );
+
+	// Descreve uma chave que fica dentro de cada elemento: o campo comeca em
+	// offset bytes do inicio do elemento e tem o tipo (e o tamanho) de type.
+	struct Key
+	{
+		size_t offset;
+		ElementType type;
+		bool descending;
+
+		Key( size_t offset, ElementType type, bool descending = false )
+			: offset( offset ), type( type ), descending( descending ) {}
+	};
+
+	/* first: inicio do array a ser ordenado;
+	 * count: quantidade de elementos;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * key: campo usado como chave (inteiros com e sem sinal, float e double);
+	 * scratch: espaco auxiliar de count*sz bytes; se for nullptr a funcao aloca de alloc e libera;
+	 * Radix sort LSD estavel, um byte da chave por passada; bytes da chave que
+	 * sao iguais em todos os elementos nao geram passada. Em float/double, -0.0
+	 * fica antes de +0.0 e NaN vai para o fim (ou para o inicio, se negativo).
+	 */
+	void radix_sort( void *first, size_t count, size_t sz, Key key, void *scratch = nullptr,
+			Allocator &alloc = default_allocator() );
+
+	/* key: funcao que devolve a chave de um elemento, comparada como inteiro sem sinal;
+	 * Demais parametros como no radix_sort acima.
+	 */
+	void radix_sort( void *first, size_t count, size_t sz,
+			std::uint32_t (*key)( const void * ), void *scratch = nullptr,
+			Allocator &alloc = default_allocator() );
+
+	void radix_sort( void *first, size_t count, size_t sz,
+			std::uint64_t (*key)( const void * ), void *scratch = nullptr,
+			Allocator &alloc = default_allocator() );
+
+	// ------------------------------------------------------------------------
+	//  Variantes com Key: a comparacao olha so o campo descrito por key, sem
+	//  chamar uma funcao por elemento. A ordem das chaves eh a de radix_sort
+	//  (decrescente se key.descending; em float/double, -0.0 antes de +0.0 e
+	//  NaN nas pontas) e duas chaves sao iguais quando tem os mesmos bits.
+	// ------------------------------------------------------------------------
+
+	/* first, last: intervalo de elementos para analisar;
+	 * sz: tamanho em bytes de cada elemento do array;
+	 * value: valor procurado, do tipo do campo (nao um elemento inteiro);
+	 * key: campo comparado;
+	 * Retorna o primeiro elemento cujo campo eh igual a value, ou last.
+	 */
+	const void *find( const void *first, const void *last, size_t sz, const void *value, Key key );
+
+	/* first, last, sz, key: como acima;
+	 * Retorna a primeira ocorrencia do elemento com a menor chave (a maior, se
+	 * key.descending), ou last se o intervalo for vazio.
+	 */
+	const void *min( const void *first, const void *last, size_t sz, Key key );
+
+	/* first, last, sz, value, key: como em find;
+	 * Os elementos cuja chave vem antes de value passam para o inicio, na
+	 * ordem original. Retorna o inicio dos demais.
+	 */
+	void *partition( void *first, void *last, size_t sz, Key key, const void *value );
+
+	/* first, count, sz: como em qsort;
+	 * key: campo usado como chave;
+	 * Como qsort acima (pdqsort, ou fusao de runs longas), comparando as
+	 * chaves como inteiros sem sinal. Nao eh estavel;
+	 * para ordenar de forma estavel pela mesma chave use radix_sort.
+	 */
+	void qsort( void *first, size_t count, size_t sz, Key key );
+
+	/* first, last, sz, key: como em find;
+	 * Remove todos os elementos cuja chave ja apareceu antes, mantendo a
+	 * primeira ocorrencia na ordem original. Usa a tabela de hash de unique,
+	 * obtida como no unique com hash e alloc.
+	 * Retorna o fim do intervalo sem repeticoes.
+	 */
+	void *unique( void *first, void *last, size_t sz, Key key, Allocator &alloc = default_allocator() );
+
+	// ------------------------------------------------------------------------
+	//  Tipos com operacoes proprias
+	// ------------------------------------------------------------------------
+
+	// Operacoes de um tipo que nao pode ser copiado byte a byte (std::string,
+	// std::vector, tipos com ponteiros para si mesmos...). Sem elas os
+	// algoritmos movem os bytes dos elementos, o que so vale para tipos
+	// trivialmente copiaveis. Os algoritmos nunca chamam move_assign ou swap
+	// com os dois ponteiros iguais.
+	struct TypeOps
+	{
+		void (*move_construct)( void *dst, void *src );  // constroi em dst (memoria crua) movendo src
+		void (*move_assign)( void *dst, void *src );     // dst = std::move(src)
+		void (*swap)( void *a, void *b );
+		void (*destroy)( void *p );
+	};
+
+	/// Operacoes de T a partir do seu construtor/atribuicao de movimento, swap e destrutor
+	template < typename T >
+	const TypeOps &type_ops()
+	{
+		static const TypeOps ops{
+			[]( void *d, void *s ) { new (d) T( std::move( *static_cast< T * >(s) ) ); },
+			[]( void *d, void *s ) { *static_cast< T * >(d) = std::move( *static_cast< T * >(s) ); },
+			[]( void *a, void *b ) { using std::swap; swap( *static_cast< T * >(a), *static_cast< T * >(b) ); },
+			[]( void *p ) { static_cast< T * >(p)->~T(); } };
+		return ops;
+	}
+
+	/* Como reverse, partition, unique e qsort acima, movendo e trocando os
+	 * elementos com ops em vez de copiar seus bytes. unique deixa os
+	 * elementos depois do retorno em estado movido (validos, valor nao
+	 * especificado), como std::unique. qsort constroi e destroi um
+	 * temporario com ops e aloca sz bytes para ele.
+	 */
+	void *reverse( void *first, void *last, size_t sz, const TypeOps &ops );
+	void *partition( void *first, void *last, size_t sz, Predicate p, const TypeOps &ops );
+	void *unique( void *first, void *last, size_t sz, Equal eq, const TypeOps &ops );
+	void *unique( void *first, void *last, size_t sz, Hash hash, Equal eq, const TypeOps &ops );
+	void qsort( void *first, size_t count, size_t sz, Compare cmp, const TypeOps &ops );
+
+	// ------------------------------------------------------------------------
+	//  Ordenacao indireta e permutacoes
+	// ------------------------------------------------------------------------
+
+	/* first: inicio dos registros;
+	 * count: quantidade de registros (com indices de 32 bits, ate UINT32_MAX;
+	 * acima disso lanca std::invalid_argument);
+	 * sz: tamanho em bytes de cada registro;
+	 * cmp: funcao binaria que retorna true se o primeiro registro for menor que o segundo;
+	 * indices: recebe count indices, tais que os registros indices[0],
+	 * indices[1], ... estao em ordem segundo cmp;
+	 * Os registros nao sao alterados: a ordenacao (pdqsort, nao estavel) so
+	 * troca indices, o que compensa quando sz eh grande. Use apply_permutation
+	 * ou gather para reordenar os registros depois.
+	 */
+	void argsort( const void *first, size_t count, size_t sz, Compare cmp, std::uint32_t *indices );
+	void argsort( const void *first, size_t count, size_t sz, Compare cmp, std::uint64_t *indices );
+
+	/* first, count, sz: registros a reordenar;
+	 * perm: permutacao de [0, count), como a devolvida por argsort;
+	 * A posicao i recebe o registro que estava em perm[i]. Os ciclos de perm
+	 * sao seguidos no lugar: cada registro eh movido uma vez, mais um
+	 * movimento por ciclo. Aloca count/8 bytes para marcar as posicoes
+	 * prontas (perm nao eh alterada) e um temporario se sz passar de 256,
+	 * ambos de alloc.
+	 */
+	void apply_permutation( void *first, size_t count, size_t sz, const std::uint32_t *perm,
+			Allocator &alloc = default_allocator() );
+	void apply_permutation( void *first, size_t count, size_t sz, const std::uint64_t *perm,
+			Allocator &alloc = default_allocator() );
+
+	/* src: registros de origem;
+	 * count: quantidade de indices (e de registros escritos);
+	 * sz: tamanho em bytes de cada registro;
+	 * indices: posicoes em src;
+	 * dst: destino com count registros, sem sobreposicao com src;
+	 * dst[i] recebe src[indices[i]]. Com os indices de argsort, reordena
+	 * qualquer array paralelo aos registros ordenados.
+	 */
+	void gather( const void *src, size_t count, size_t sz, const std::uint32_t *indices, void *dst );
+	void gather( const void *src, size_t count, size_t sz, const std::uint64_t *indices, void *dst );
+
+	/* Parametros como em gather; dst[indices[i]] recebe src[i]. Desfaz um
+	 * gather feito com os mesmos indices.
+	 */
+	void scatter( const void *src, size_t count, size_t sz, const std::uint32_t *indices, void *dst );
+	void scatter( const void *src, size_t count, size_t sz, const std::uint64_t *indices, void *dst );
+
+	// ========================================================================
+	//  Camada tipada
+	//
+	//  As funcoes acima chamam cmp/p/eq atraves de um ponteiro de funcao para
+	//  cada elemento, o que impede o compilador de fazer inline. As versoes
+	//  abaixo recebem ponteiros tipados e qualquer objeto chamavel (lambda,
+	//  functor ou funcao), e sao compiladas em um laco totalmente inline.
+	//  As versoes void* encaminham para o mesmo nucleo em graal::detail.
+	// ========================================================================
+
+	namespace detail
+	{
+		using byte = unsigned char;
+
+		/// Nucleo de min: primeira ocorrencia do menor elemento em [first, last) com passo sz
+		template < typename Cmp >
+		inline const byte *min( const byte *first, const byte *last, size_t sz, Cmp cmp )
+		{
+			if(first==last)
+				return last;
+
+			const byte *menor = first;
+			for(const byte *it = first+sz; it!=last; it += sz)
+			{
+				if(cmp(it, menor))
+					menor = it;
+			}
+			return menor;
+		}
+
+		/// Nucleo de find_if: primeiro elemento em [first, last) para o qual p eh verdadeiro, ou last
+		template < typename Pred >
+		inline const byte *find_if( const byte *first, const byte *last, size_t sz, Pred p )
+		{
+			for(const byte *it = first; it!=last; it += sz)
+			{
+				if(p(it))
+					return it;
+			}
+			return last;
+		}
+
+		/// Elementos avaliados de uma vez pelo nucleo de partition
+		const size_t BLOCO_PARTITION = 64;
+
+		/* Nucleo de partition: os elementos com p verdadeiro passam para o inicio,
+		 * na ordem original; sw troca dois elementos. O predicado eh avaliado em
+		 * blocos, guardando sem desvios as posicoes dos verdadeiros, e depois as
+		 * trocas do bloco sao feitas em sequencia. O resultado eh o mesmo de
+		 * trocar a cada verdadeiro, sem o desvio imprevisivel em p(it).
+		 */
+		template < typename Pred, typename Swap >
+		inline byte *partition( byte *first, byte *last, size_t sz, Pred p, Swap sw )
+		{
+			unsigned char pos[BLOCO_PARTITION];
+			byte *aux = first;
+
+			while(first!=last)
+			{
+				size_t m = (last-first) / sz;
+				if(m > BLOCO_PARTITION)
+					m = BLOCO_PARTITION;
+
+				size_t num = 0;
+				for(size_t i = 0; i < m; ++i)
+				{
+					pos[num] = (unsigned char) i;
+					num += p(first + i*sz) ? 1 : 0;
+				}
+
+				for(size_t j = 0; j < num; ++j)
+				{
+					byte *it = first + pos[j]*sz;
+					if(it!=aux)
+						sw(aux, it);
+					aux += sz;
+				}
+				first += m*sz;
+			}
+			return aux;
+		}
+
+		/// Converte um ponteiro tipado para o ponteiro de bytes usado pelos nucleos
+		template < typename T >
+		inline const byte *bytes( const T *p ) { return reinterpret_cast< const byte * >(p); }
+
+		template < typename T >
+		inline byte *bytes( T *p ) { return reinterpret_cast< byte * >(p); }
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * cmp: objeto chamavel cmp(const T&, const T&) que retorna true se o primeiro for menor;
+	 */
+	template < typename T, typename Cmp >
+	const T *min( const T *first, const T *last, Cmp cmp )
+	{
+		return reinterpret_cast< const T * >(
+			detail::min( detail::bytes(first), detail::bytes(last), sizeof(T),
+				[&cmp]( const void *a, const void *b )
+				{ return cmp( *static_cast< const T * >(a), *static_cast< const T * >(b) ); } ) );
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * p: objeto chamavel p(const T&) que retorna verdadeiro para o elemento requerido;
+	 */
+	template < typename T, typename Pred >
+	const T *find_if( const T *first, const T *last, Pred p )
+	{
+		return reinterpret_cast< const T * >(
+			detail::find_if( detail::bytes(first), detail::bytes(last), sizeof(T),
+				[&p]( const void *e ) { return p( *static_cast< const T * >(e) ); } ) );
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * value: valor para comparar os elementos;
+	 * eq: objeto chamavel eq(const T&, const T&) que retorna true se os elementos forem iguais;
+	 */
+	template < typename T, typename Eq >
+	const T *find( const T *first, const T *last, const T &value, Eq eq )
+	{
+		return find_if( first, last, [&value, &eq]( const T &e ) { return eq( e, value ); } );
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * value: valor para comparar os elementos usando operator==;
+	 */
+	template < typename T >
+	const T *find( const T *first, const T *last, const T &value )
+	{
+		return find_if( first, last, [&value]( const T &e ) { return e == value; } );
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * p: objeto chamavel p(const T&) que retorna verdadeiro para o elemento requerido;
+	 */
+	template < typename T, typename Pred >
+	bool all_of( const T *first, const T *last, Pred p )
+	{
+		return find_if( first, last, [&p]( const T &e ) { return !p(e); } ) == last;
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * p: objeto chamavel p(const T&) que retorna verdadeiro para o elemento requerido;
+	 */
+	template < typename T, typename Pred >
+	bool any_of( const T *first, const T *last, Pred p )
+	{
+		return find_if( first, last, p ) != last;
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * p: objeto chamavel p(const T&) que retorna verdadeiro para o elemento requerido;
+	 */
+	template < typename T, typename Pred >
+	bool none_of( const T *first, const T *last, Pred p )
+	{
+		return find_if( first, last, p ) == last;
+	}
+
+	/* first, last: intervalo de elementos do tipo T;
+	 * p: objeto chamavel p(const T&) que retorna verdadeiro para o elemento requerido;
+	 * Os elementos sao trocados com swap(T&, T&), entao qualquer tipo movel eh aceito.
+	 */
+	template < typename T, typename Pred >
+	T *partition( T *first, T *last, Pred p )
+	{
+		return reinterpret_cast< T * >(
+			detail::partition( detail::bytes(first), detail::bytes(last), sizeof(T),
+				[&p]( const void *e ) { return p( *static_cast< const T * >(e) ); },
+				[]( void *a, void *b )
+				{
+					using std::swap;
+					swap( *static_cast< T * >(a), *static_cast< T * >(b) );
+				} ) );
+	}
 }
 #endif
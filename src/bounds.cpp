@@ -0,0 +1,148 @@
+#include "../include/graal.h"
+
+// lower_bound, upper_bound, equal_range e binary_search em intervalos
+// ordenados.
+//
+// A busca binaria classica desvia conforme o resultado de cada comparacao,
+// que eh imprevisivel. Aqui o laco so reduz o tamanho do intervalo: a
+// metade escolhida vira um select (cmov) sobre o inicio, e o numero de
+// iteracoes depende apenas de n. Sem desvio a CPU nao sabe qual dos dois
+// proximos pontos medios sera lido, entao os dois sao pedidos com prefetch
+// uma iteracao antes; em arrays maiores que a cache isso sobrepoe as faltas
+// de cache de iteracoes seguidas.
+//
+// As versoes em lote vao alem: como o numero de iteracoes so depende de n,
+// um grupo de buscas anda junto, uma iteracao de cada busca por vez. Ao
+// atualizar uma busca, o proximo ponto medio dela (ja conhecido) recebe
+// prefetch, e so eh lido depois das iteracoes das outras buscas do grupo.
+// Assim ha ate GRUPO faltas de cache em andamento ao mesmo tempo.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/* Primeiro elemento de [first, first + n*sz) para o qual antes(e) eh falso,
+	 * com antes verdadeiro em um prefixo do intervalo (ou last se for em todos).
+	 */
+	template < typename Antes >
+	const byte *divide( const byte *first, size_t n, size_t sz, Antes antes )
+	{
+		if(n == 0)
+			return first;
+
+		const byte *base = first;
+		while(n > 1)
+		{
+			size_t metade = n/2;
+			size_t resto = n - metade;
+
+			// Pontos medios da proxima iteracao, para as duas metades possiveis
+			__builtin_prefetch(base + (resto/2)*sz);
+			__builtin_prefetch(base + (metade + resto/2)*sz);
+
+			base = antes(base + metade*sz) ? base + metade*sz : base;
+			n = resto;
+		}
+		return antes(base) ? base + sz : base;
+	}
+
+	/// Buscas intercaladas em cada lote
+	const size_t GRUPO = 16;
+
+	/* Como divide, para count chaves de sz bytes a partir de keys; antes(e, k)
+	 * diz se e fica antes do resultado da chave k. out recebe os indices.
+	 */
+	template < typename Antes >
+	void divide_lote( const byte *first, size_t n, size_t sz, const byte *keys, size_t count,
+			size_t *out, Antes antes )
+	{
+		const byte *base[GRUPO];
+
+		for(size_t g0 = 0; g0 < count; g0 += GRUPO)
+		{
+			const size_t G = count-g0 < GRUPO ? count-g0 : GRUPO;
+			const byte *k = keys + g0*sz;
+
+			if(n == 0)
+			{
+				for(size_t g = 0; g < G; ++g)
+					out[g0+g] = 0;
+				continue;
+			}
+
+			for(size_t g = 0; g < G; ++g)
+				base[g] = first;
+			__builtin_prefetch(first + (n/2)*sz);
+
+			for(size_t m = n; m > 1; )
+			{
+				size_t metade = m/2;
+				size_t resto = m - metade;
+				for(size_t g = 0; g < G; ++g)
+				{
+					const byte *meio = base[g] + metade*sz;
+					base[g] = antes(meio, k + g*sz) ? meio : base[g];
+
+					// Ponto medio da proxima iteracao desta busca
+					__builtin_prefetch(base[g] + (resto/2)*sz);
+				}
+				m = resto;
+			}
+
+			for(size_t g = 0; g < G; ++g)
+				out[g0+g] = (base[g]-first) / sz + (antes(base[g], k + g*sz) ? 1 : 0);
+		}
+	}
+}
+
+/// A funcao retorna o primeiro elemento de [first; last) que nao eh menor que value
+const void *graal::lower_bound( const void *first, const void *last, size_t sz,
+		const void *value, Compare cmp )
+{
+	const byte *it = (const byte*) first;
+	return divide( it, ((const byte*) last - it) / sz, sz,
+			[value, cmp]( const byte *e ) { return cmp(e, value); } );
+}
+
+/// A funcao retorna o primeiro elemento de [first; last) maior que value
+const void *graal::upper_bound( const void *first, const void *last, size_t sz,
+		const void *value, Compare cmp )
+{
+	const byte *it = (const byte*) first;
+	return divide( it, ((const byte*) last - it) / sz, sz,
+			[value, cmp]( const byte *e ) { return !cmp(value, e); } );
+}
+
+/// A funcao retorna o subintervalo de [first; last) com os elementos equivalentes a value
+std::pair< const void *, const void * > graal::equal_range( const void *first, const void *last,
+		size_t sz, const void *value, Compare cmp )
+{
+	const void *lo = lower_bound( first, last, sz, value, cmp );
+	return { lo, upper_bound( lo, last, sz, value, cmp ) };
+}
+
+/// A funcao retorna true se [first; last) tiver um elemento equivalente a value
+bool graal::binary_search( const void *first, const void *last, size_t sz,
+		const void *value, Compare cmp )
+{
+	const void *lo = lower_bound( first, last, sz, value, cmp );
+	return lo != last && !cmp(value, lo);
+}
+
+/// A funcao calcula lower_bound para count chaves, intercalando as buscas
+void graal::batch_lower_bound( const void *first, const void *last, size_t sz,
+		const void *keys, size_t count, size_t *out, Compare cmp )
+{
+	const byte *it = (const byte*) first;
+	divide_lote( it, ((const byte*) last - it) / sz, sz, (const byte*) keys, count, out,
+			[cmp]( const byte *e, const byte *k ) { return cmp(e, k); } );
+}
+
+/// A funcao calcula upper_bound para count chaves, intercalando as buscas
+void graal::batch_upper_bound( const void *first, const void *last, size_t sz,
+		const void *keys, size_t count, size_t *out, Compare cmp )
+{
+	const byte *it = (const byte*) first;
+	divide_lote( it, ((const byte*) last - it) / sz, sz, (const byte*) keys, count, out,
+			[cmp]( const byte *e, const byte *k ) { return !cmp(k, e); } );
+}
@@ -0,0 +1,110 @@
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include "bulk.h"
+#include "simd.h"
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Bytes copiados por iteracao do laco nao temporal
+	const size_t PASSO = 64;
+
+#ifdef GRAAL_X86
+	/// Copia n bytes (multiplo de PASSO) do inicio para o fim; d alinhado em 16
+	void stream_frente( byte *d, const byte *s, size_t n )
+	{
+		for(size_t i = 0; i < n; i += PASSO)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*) (s+i));
+			__m128i b = _mm_loadu_si128((const __m128i*) (s+i+16));
+			__m128i c = _mm_loadu_si128((const __m128i*) (s+i+32));
+			__m128i e = _mm_loadu_si128((const __m128i*) (s+i+48));
+			_mm_stream_si128((__m128i*) (d+i), a);
+			_mm_stream_si128((__m128i*) (d+i+16), b);
+			_mm_stream_si128((__m128i*) (d+i+32), c);
+			_mm_stream_si128((__m128i*) (d+i+48), e);
+		}
+	}
+
+	/// Copia n bytes (multiplo de PASSO) do fim para o inicio; d alinhado em 16
+	void stream_tras( byte *d, const byte *s, size_t n )
+	{
+		for(size_t i = n; i > 0; i -= PASSO)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*) (s+i-16));
+			__m128i b = _mm_loadu_si128((const __m128i*) (s+i-32));
+			__m128i c = _mm_loadu_si128((const __m128i*) (s+i-48));
+			__m128i e = _mm_loadu_si128((const __m128i*) (s+i-64));
+			_mm_stream_si128((__m128i*) (d+i-16), a);
+			_mm_stream_si128((__m128i*) (d+i-32), b);
+			_mm_stream_si128((__m128i*) (d+i-48), c);
+			_mm_stream_si128((__m128i*) (d+i-64), e);
+		}
+	}
+
+	/// Copia com stores nao temporais; o sentido evita sobrescrever origem ainda nao lida
+	void move_streaming( byte *d, const byte *s, size_t n )
+	{
+		// Bytes ate o destino ficar alinhado em 16, exigido por _mm_stream_si128
+		size_t cabeca = (16 - ((std::uintptr_t) d & 15)) & 15;
+		size_t meio = (n-cabeca) - (n-cabeca) % PASSO;
+		size_t cauda = n - cabeca - meio;
+
+		if(d <= s || d >= s+n)
+		{
+			std::memmove(d, s, cabeca);
+			stream_frente(d+cabeca, s+cabeca, meio);
+			std::memmove(d+cabeca+meio, s+cabeca+meio, cauda);
+		}
+		else
+		{
+			std::memmove(d+cabeca+meio, s+cabeca+meio, cauda);
+			stream_tras(d+cabeca, s+cabeca, meio);
+			std::memmove(d, s, cabeca);
+		}
+
+		// Os stores nao temporais ficam visiveis para as outras threads apos o sfence
+		_mm_sfence();
+	}
+#endif
+
+	/// Maior cache informada pelo sistema, ou 32 MiB se nao houver informacao
+	size_t maior_cache()
+	{
+		long tam = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+		tam = sysconf(_SC_LEVEL3_CACHE_SIZE);
+		if(tam <= 0)
+			tam = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+		return tam > 0 ? (size_t) tam : (size_t) 32 << 20;
+	}
+}
+
+/// Tamanho, em bytes, a partir do qual Auto usa stores nao temporais
+size_t graal::bulk::limite_streaming()
+{
+	static const size_t limite = maior_cache();
+	return limite;
+}
+
+/// Copia n bytes de s para d, aceitando sobreposicao
+void graal::bulk::move( void *d, const void *s, size_t n, CopyMode mode )
+{
+#ifdef GRAAL_X86
+	bool streaming = mode==CopyMode::Streaming
+		|| (mode==CopyMode::Auto && n > limite_streaming());
+
+	// Abaixo de alguns passos o alinhamento nao compensa
+	if(streaming && n >= 4*PASSO)
+	{
+		move_streaming((byte*) d, (const byte*) s, n);
+		return;
+	}
+#else
+	(void) mode;
+#endif
+	std::memmove(d, s, n);
+}
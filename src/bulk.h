@@ -0,0 +1,25 @@
+#ifndef GRAAL_BULK
+#define GRAAL_BULK
+
+#include <cstddef>
+#include "../include/graal.h"
+
+// Copia de blocos de bytes inteiros, usada por copy, copy_backward, move e
+// clone. Aceita sobreposicao entre origem e destino em qualquer sentido.
+
+namespace graal
+{
+	namespace bulk
+	{
+		/* d, s: destino e origem, podendo se sobrepor;
+		 * n: quantidade de bytes;
+		 * mode: Streaming usa stores nao temporais, que nao trazem o destino
+		 * para a cache; Auto faz isso apenas quando n passa de limite_streaming().
+		 */
+		void move( void *d, const void *s, size_t n, CopyMode mode );
+
+		/// Tamanho, em bytes, a partir do qual Auto usa stores nao temporais (a maior cache)
+		size_t limite_streaming();
+	}
+}
+#endif
@@ -0,0 +1,99 @@
+#ifndef GRAAL_CAMPO
+#define GRAAL_CAMPO
+
+#include <cstring>
+#include <cstdint>
+#include "../include/graal.h"
+
+// Leitura de chaves descritas por Key.
+//
+// O campo eh lido como um inteiro sem sinal U do mesmo tamanho e
+// transformado de forma que a ordem de U seja a ordem da chave: com sinal
+// inverte o bit mais alto; float/double negativos tem todos os bits
+// invertidos e positivos so o bit mais alto; ordem decrescente inverte todos
+// os bits. Assim os algoritmos comparam apenas inteiros sem sinal, sem
+// chamar uma funcao, e so ha uma instancia por tamanho de chave.
+//
+// Em float/double a ordem eh total: -0.0 fica antes de +0.0, NaN positivo
+// depois de todos os numeros e NaN negativo antes. Duas chaves sao iguais
+// quando tem os mesmos bits.
+
+namespace graal
+{
+	namespace campos
+	{
+		using byte = detail::byte;
+
+		/// Le uma chave de sizeof(U) bytes em offset e aplica a transformacao que preserva a ordem
+		template < typename U >
+		struct LeCampo
+		{
+			size_t offset;
+			U xor_fixo;     // bit mais alto (com sinal / float), complementado se decrescente
+			U mascara_neg;  // bits extras invertidos quando um float eh negativo
+
+			static const int BYTES = sizeof(U);
+
+			/// Transforma um valor ja lido do campo
+			U transforma( U x ) const
+			{
+				// Todos os bits em 1 se o bit de sinal estiver ligado
+				U sinal = (U) 0 - (U) (x >> (8*sizeof(U)-1));
+				return x ^ xor_fixo ^ (sinal & mascara_neg);
+			}
+
+			U operator()( const byte *e ) const
+			{
+				U x;
+				std::memcpy(&x, e+offset, sizeof(U));
+				return transforma(x);
+			}
+
+			/// Chave transformada de um valor avulso do tipo do campo (nao de um elemento)
+			U valor( const void *v ) const
+			{
+				U x;
+				std::memcpy(&x, v, sizeof(U));
+				return transforma(x);
+			}
+		};
+
+		/// Monta o leitor de um campo do tipo U descrito por key
+		template < typename U >
+		LeCampo< U > campo( const Key &key, bool com_sinal, bool flutuante )
+		{
+			const U alto = (U) ((U) 1 << (8*sizeof(U)-1));
+			LeCampo< U > ler;
+			ler.offset = key.offset;
+			ler.xor_fixo = (com_sinal || flutuante) ? alto : 0;
+			ler.mascara_neg = flutuante ? (U) ~alto : 0;
+			if(key.descending)
+				ler.xor_fixo = (U) ~ler.xor_fixo;
+			return ler;
+		}
+
+		/* key: chave a ler;
+		 * f: objeto com operator() template que recebe o LeCampo< U > de key;
+		 * Retorna o que f retornar.
+		 */
+		template < typename F >
+		auto despacha( const Key &key, F f ) -> decltype( f( LeCampo< std::uint8_t >() ) )
+		{
+			switch(key.type)
+			{
+				case ElementType::Int8:   return f( campo< std::uint8_t >(key, true, false) );
+				case ElementType::UInt8:  return f( campo< std::uint8_t >(key, false, false) );
+				case ElementType::Int16:  return f( campo< std::uint16_t >(key, true, false) );
+				case ElementType::UInt16: return f( campo< std::uint16_t >(key, false, false) );
+				case ElementType::Int32:  return f( campo< std::uint32_t >(key, true, false) );
+				case ElementType::UInt32: return f( campo< std::uint32_t >(key, false, false) );
+				case ElementType::Int64:  return f( campo< std::uint64_t >(key, true, false) );
+				case ElementType::UInt64: return f( campo< std::uint64_t >(key, false, false) );
+				case ElementType::Float:  return f( campo< std::uint32_t >(key, false, true) );
+				case ElementType::Double: break;
+			}
+			return f( campo< std::uint64_t >(key, false, true) );
+		}
+	}
+}
+#endif
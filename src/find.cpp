@@ -0,0 +1,202 @@
+#include <cstring>
+#include <cstdint>
+#include "../include/graal.h"
+#include "simd.h"
+#include "campo.h"
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Inteiro sem sinal com SZ bytes, usado para comparar elementos bit a bit
+	template < size_t SZ > struct Palavra;
+	template <> struct Palavra< 1 > { using tipo = std::uint8_t; };
+	template <> struct Palavra< 2 > { using tipo = std::uint16_t; };
+	template <> struct Palavra< 4 > { using tipo = std::uint32_t; };
+	template <> struct Palavra< 8 > { using tipo = std::uint64_t; };
+
+	/// Laco escalar: compara cada elemento com o alvo como um inteiro de SZ bytes
+	template < size_t SZ >
+	const byte *find_escalar( const byte *it, const byte *last, const byte *alvo )
+	{
+		typename Palavra< SZ >::tipo v, x;
+		std::memcpy(&v, alvo, SZ);
+
+		for(; it!=last; it += SZ)
+		{
+			std::memcpy(&x, it, SZ);
+			if(x==v)
+				return it;
+		}
+		return last;
+	}
+
+#ifdef GRAAL_X86
+	/// Vetor de W bytes com o alvo repetido W/SZ vezes
+	template < size_t SZ, size_t W >
+	void repete( byte (&buf)[W], const byte *alvo )
+	{
+		for(size_t i = 0; i < W; i += SZ)
+			std::memcpy(buf+i, alvo, SZ);
+	}
+
+	/// Compara lanes de SZ bytes: lanes iguais ficam com todos os bits em 1
+	template < size_t SZ >
+	inline __m128i iguais_sse2( __m128i a, __m128i b )
+	{
+		switch(SZ)
+		{
+			case 1: return _mm_cmpeq_epi8(a, b);
+			case 2: return _mm_cmpeq_epi16(a, b);
+			case 4: return _mm_cmpeq_epi32(a, b);
+		}
+		// SSE2 nao compara 64 bits: as duas metades de 32 bits precisam ser iguais
+		__m128i c = _mm_cmpeq_epi32(a, b);
+		return _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+
+	/// Busca com SSE2, 32 bytes por iteracao
+	template < size_t SZ >
+	const byte *find_sse2( const byte *it, const byte *last, const byte *alvo )
+	{
+		byte buf[16];
+		repete< SZ >(buf, alvo);
+		const __m128i v = _mm_loadu_si128((const __m128i*) buf);
+
+		while(last-it >= 32)
+		{
+			__m128i a = iguais_sse2< SZ >(_mm_loadu_si128((const __m128i*) it), v);
+			__m128i b = iguais_sse2< SZ >(_mm_loadu_si128((const __m128i*) (it+16)), v);
+			unsigned m = (unsigned) _mm_movemask_epi8(a) | ((unsigned) _mm_movemask_epi8(b) << 16);
+
+			// O bit menos significativo indica o primeiro byte do primeiro elemento igual
+			if(m)
+				return it + __builtin_ctz(m);
+			it += 32;
+		}
+
+		return find_escalar< SZ >(it, last, alvo);
+	}
+
+	template < size_t SZ >
+	GRAAL_AVX2 inline __m256i iguais_avx2( __m256i a, __m256i b )
+	{
+		switch(SZ)
+		{
+			case 1: return _mm256_cmpeq_epi8(a, b);
+			case 2: return _mm256_cmpeq_epi16(a, b);
+			case 4: return _mm256_cmpeq_epi32(a, b);
+		}
+		return _mm256_cmpeq_epi64(a, b);
+	}
+
+	/// Busca com AVX2, 64 bytes por iteracao
+	template < size_t SZ >
+	GRAAL_AVX2 const byte *find_avx2( const byte *it, const byte *last, const byte *alvo )
+	{
+		byte buf[32];
+		repete< SZ >(buf, alvo);
+		const __m256i v = _mm256_loadu_si256((const __m256i*) buf);
+
+		while(last-it >= 64)
+		{
+			__m256i a = iguais_avx2< SZ >(_mm256_loadu_si256((const __m256i*) it), v);
+			__m256i b = iguais_avx2< SZ >(_mm256_loadu_si256((const __m256i*) (it+32)), v);
+			std::uint64_t m = (std::uint32_t) _mm256_movemask_epi8(a)
+				| ((std::uint64_t) (std::uint32_t) _mm256_movemask_epi8(b) << 32);
+
+			if(m)
+				return it + __builtin_ctzll(m);
+			it += 64;
+		}
+
+		return find_sse2< SZ >(it, last, alvo);
+	}
+#endif
+
+	/// Escolhe a melhor busca disponivel para elementos de SZ bytes
+	template < size_t SZ >
+	const byte *find_bits( const byte *first, const byte *last, const byte *alvo )
+	{
+#ifdef GRAAL_X86
+		if(graal::simd::tem_avx2())
+			return find_avx2< SZ >(first, last, alvo);
+		return find_sse2< SZ >(first, last, alvo);
+#else
+		return find_escalar< SZ >(first, last, alvo);
+#endif
+	}
+
+	/// Elementos testados de uma vez por procura_campo
+	const size_t BLOCO_CAMPO = 32;
+
+	/// Busca pelos bits do campo: testa um bloco inteiro sem desvios e so entao verifica se achou
+	struct procura_campo
+	{
+		const byte *first, *last;
+		size_t sz;
+		const void *value;
+
+		template < typename U >
+		const byte *operator()( graal::campos::LeCampo< U > ler ) const
+		{
+			// A transformacao da chave nao muda a igualdade: compara os bits lidos
+			U v;
+			std::memcpy(&v, value, sizeof(U));
+			const byte *it = first + ler.offset;
+			size_t n = (last-first) / sz;
+
+			for(; n >= BLOCO_CAMPO; n -= BLOCO_CAMPO, it += BLOCO_CAMPO*sz)
+			{
+				std::uint32_t achou = 0;
+				for(size_t j = 0; j < BLOCO_CAMPO; ++j)
+				{
+					U x;
+					std::memcpy(&x, it + j*sz, sizeof(U));
+					achou |= (std::uint32_t) (x==v) << j;
+				}
+				if(achou)
+					return it - ler.offset + __builtin_ctz(achou)*sz;
+			}
+			for(; n > 0; --n, it += sz)
+			{
+				U x;
+				std::memcpy(&x, it, sizeof(U));
+				if(x==v)
+					return it - ler.offset;
+			}
+			return last;
+		}
+	};
+}
+
+/// A funcao recebe um intervalo [first; last) e um elemento alvo, e retorna o primeiro ponteiro cujos bytes sao iguais aos do alvo
+const void *graal::find( const void *first, const void *last, size_t sz,
+		const void *value, Bitwise )
+{
+	const byte *it = (const byte*) first;
+	const byte *at = (const byte*) last;
+	const byte *alvo = (const byte*) value;
+
+	switch(sz)
+	{
+		case 1: return find_bits< 1 >(it, at, alvo);
+		case 2: return find_bits< 2 >(it, at, alvo);
+		case 4: return find_bits< 4 >(it, at, alvo);
+		case 8: return find_bits< 8 >(it, at, alvo);
+	}
+
+	// Demais tamanhos: compara os bytes de cada elemento com memcmp
+	for(; it!=at; it += sz)
+	{
+		if(std::memcmp(it, alvo, sz)==0)
+			return it;
+	}
+	return at;
+}
+
+/// A funcao retorna o primeiro elemento de [first; last) cujo campo descrito por key eh igual a value
+const void *graal::find( const void *first, const void *last, size_t sz, const void *value, Key key )
+{
+	return campos::despacha( key, procura_campo{ (const byte*) first, (const byte*) last, sz, value } );
+}
@@ -1,108 +1,232 @@
-#define GRAAL
 #include <iostream>
 #include <iterator>
 #include <cstring>
 #include "../include/graal.h"
+#include "kernels.h"
+#include "bulk.h"
+#include "campo.h"
 
-using byte = unsigned char;
+using byte = graal::detail::byte;
 
-/// A função encontra e retorna a primeira ocorrência do menor elemento no intervalo [first, last)
-const void *graal::min( const void *first, const void *last, size_t sz, Compare cmp )
+namespace
 {
-	const byte *menor = (const byte*) first;	
-	const byte *it = (const byte*) first;		
-	// Para comecar da segunda posicao
-	it += sz;	
+	/// Particiona [first, last) com o predicado p trocando elementos com o nucleo k
+	template < typename Pred = graal::Predicate >
+	struct faz_partition
+	{
+		byte *first, *last;
+		Pred p;
 
-	while(it!=last)
-	{	
-		if(cmp(it, menor))
-			// Guarda o menor valor
-			menor = it;		
+		template < typename K >
+		byte *operator()( K k ) const
+		{
+			return graal::detail::partition( first, last, k.size(), p,
+					[k]( void *a, void *b ) { k.troca(a, b); } );
+		}
+	};
 
-		// Próxima posicao do array
-		it += sz;
-	} 
+	/// Primeiro elemento de [first, last) cujo resultado em p for valor, ou last
+	const byte *find_lote( const byte *first, const byte *last, size_t sz, graal::BatchPredicate p, bool valor )
+	{
+		std::uint8_t mascara[graal::BATCH_SIZE];
+		for(const byte *it = first; it!=last; )
+		{
+			size_t m = (last-it) / sz;
+			if(m > graal::BATCH_SIZE)
+				m = graal::BATCH_SIZE;
+
+			// Pela contagem o lote pode nao ter o valor procurado, sem olhar a mascara
+			size_t c = p(it, m, sz, mascara);
+			if(valor ? c!=0 : c!=m)
+			{
+				for(size_t j = 0; j < m; ++j)
+					if((mascara[j]!=0) == valor)
+						return it + j*sz;
+			}
+			it += m*sz;
+		}
+		return last;
+	}
 
-	return menor;
-}
+	/// Particiona [first, last) com o predicado em lote p trocando elementos com o nucleo k
+	struct faz_partition_lote
+	{
+		byte *first, *last;
+		graal::BatchPredicate p;
 
-/// A funcao inverte a ordem dos elementos do vetor no intervalo [first, last)
-void *graal::reverse( void *first, void *last, size_t sz )
-{
-	byte *aux = new byte[sz];
+		template < typename K >
+		byte *operator()( K k ) const
+		{
+			const size_t sz = k.size();
+			std::uint8_t mascara[graal::BATCH_SIZE];
+			std::uint8_t pos[graal::BATCH_SIZE];
+			byte *aux = first;
+
+			for(byte *it = first; it!=last; )
+			{
+				size_t m = (last-it) / sz;
+				if(m > graal::BATCH_SIZE)
+					m = graal::BATCH_SIZE;
+
+				// Mesmas trocas do nucleo de partition, com as posicoes tiradas da mascara
+				if(p(it, m, sz, mascara) != 0)
+				{
+					size_t num = 0;
+					for(size_t j = 0; j < m; ++j)
+					{
+						pos[num] = (std::uint8_t) j;
+						num += mascara[j]!=0;
+					}
+					for(size_t j = 0; j < num; ++j)
+					{
+						byte *e = it + pos[j]*sz;
+						if(e!=aux)
+							k.troca(aux, e);
+						aux += sz;
+					}
+				}
+				it += m*sz;
+			}
+			return aux;
+		}
+	};
+
+	/* Passada unica de scan_stats. Ordem e Conta dizem se cmp e pred foram
+	 * dados; cada combinacao gera um laco sem testes dessas flags. O resultado
+	 * deve chegar com todos os ponteiros em last e as contagens zeradas.
+	 */
+	template < bool Ordem, bool Conta >
+	void varre_stats( const byte *first, const byte *last, size_t sz,
+			const graal::ScanSpec &spec, graal::ScanStats &r )
+	{
+		if(first==last)
+			return;
 
-	// Ponteiros para first e last
-	byte *it = (byte*) first;
-	byte *at = (byte*) last;
+		graal::Compare cmp = spec.cmp;
+		graal::Predicate pred = spec.pred;
+		const bool ultimo_maior = spec.last_max;
 
-	while(it<at)
-	{
-		// Faz a troca dos elementos 
-		std::memcpy(aux, it, sz);
-		std::memcpy(it, at, sz);
-		std::memcpy(at, aux, sz);
+		const byte *menor = first, *maior = first;
+		const byte *primeiro = last, *ultimo = last;
+		size_t cont = 0;
 
-		// Próxima posicao do first
-		it += sz;
+		for(const byte *it = first; it!=last; it += sz)
+		{
+			if(Ordem && it!=first)
+			{
+				// Menor que o menor nao pode ser maior que o maior
+				if(cmp(it, menor))
+					menor = it;
+				else if(ultimo_maior ? !cmp(it, maior) : cmp(maior, it))
+					maior = it;
+			}
+			if(Conta && pred(it))
+			{
+				if(cont == 0)
+					primeiro = it;
+				ultimo = it;
+				++cont;
+			}
+		}
 
-		// Posicao anterior do last
-		at -= sz;
+		if(Ordem)
+		{
+			r.min = menor;
+			r.max = maior;
+		}
+		if(Conta)
+		{
+			r.first_match = primeiro;
+			r.last_match = ultimo;
+			r.count = cont;
+		}
 	}
 
-	return aux;	
+	/// Particiona pelo campo lido por ler: a chave vem antes da de value
+	struct faz_partition_campo
+	{
+		byte *first, *last;
+		size_t sz;
+		const void *value;
+
+		template < typename U >
+		byte *operator()( graal::campos::LeCampo< U > ler ) const
+		{
+			const U v = ler.valor(value);
+			auto antes = [ler, v]( const byte *e ) { return ler(e) < v; };
+			return graal::kernels::despacha( sz, faz_partition< decltype(antes) >{ first, last, antes } );
+		}
+	};
 }
 
-/// A funcao copia os valores do intervalo em um novo array
-void *graal::copy( const void *first, const void *last, const void *d_first, size_t sz )
+/// A função encontra e retorna a primeira ocorrência do menor elemento no intervalo [first, last)
+const void *graal::min( const void *first, const void *last, size_t sz, Compare cmp )
 {
-	byte *it = (byte*) first;
-	byte *at = (byte*) last;
+	return detail::min( (const byte*) first, (const byte*) last, sz, cmp );
+}
 
-	byte *d_it = (byte*) d_first;
+/// A funcao calcula em uma unica passada o menor e o maior elemento, a contagem e a primeira e a ultima ocorrencia de pred
+graal::ScanStats graal::scan_stats( const void *first, const void *last, size_t sz, const ScanSpec &spec )
+{
+	const byte *it = (const byte*) first;
+	const byte *at = (const byte*) last;
 
-	// Aponta para o endereco após o ultimo elemento do intervalo [first, last)
-	byte *d_at = (byte*) d_it;
+	ScanStats r{ at, at, at, at, 0, (size_t) (at-it) / sz };
+	if(spec.cmp && spec.pred)
+		varre_stats< true, true >(it, at, sz, spec, r);
+	else if(spec.cmp)
+		varre_stats< true, false >(it, at, sz, spec, r);
+	else if(spec.pred)
+		varre_stats< false, true >(it, at, sz, spec, r);
+	return r;
+}
 
-	while(it!=at)
-	{
-		// Copia o valor do endereco it para d_it
-		std::memcpy(d_it, it, sz);
+/// A funcao copia os valores do intervalo em um novo array
+void *graal::copy( const void *first, const void *last, const void *d_first, size_t sz,
+		CopyMode mode )
+{
+	return graal::move( first, last, (void*) d_first, sz, mode );
+}
 
-		// Proxima posicao do array
-		it += sz;
-		d_it += sz;
+/// A funcao copia o intervalo [first; last) para o destino que termina em d_last, do ultimo elemento para o primeiro
+void *graal::copy_backward( const void *first, const void *last, void *d_last, size_t sz,
+		CopyMode mode )
+{
+	// Todo o intervalo de uma vez, como em move
+	(void) sz;
+	size_t n = (const byte*) last - (const byte*) first;
+	byte *d_first = (byte*) d_last - n;
 
-		d_at = d_it;
-	}
+	bulk::move( d_first, first, n, mode );
 
-	d_at += sz;
+	return d_first;
+}
 
-	// Retorna o ponteiro para o endereco que contem a copia do intervalo
-	return d_at;
+/// A funcao move o intervalo [first; last) para d_first, mesmo que os dois se sobreponham
+void *graal::move( const void *first, const void *last, void *d_first, size_t sz,
+		CopyMode mode )
+{
+	// Todo o intervalo de uma vez: sz nao importa para a copia de bytes
+	(void) sz;
+	size_t n = (const byte*) last - (const byte*) first;
+	bulk::move( d_first, first, n, mode );
+
+	// Retorna o ponteiro para o endereco apos o ultimo elemento copiado
+	return (byte*) d_first + n;
 }
 
 /// A funcao recebe um intervalo [first; last) e retorna um ponteiro para um novo array contendo a copia do intervalo original
 void *graal::clone( const void *first, const void *last, size_t sz )
 {
-	byte *it = (byte*) first;
-	byte *at = (byte*) last;
-
-	// Calculando o tamanho do array original
-	int dis = (at-it)/sz;
+	// Os bytes sao copiados de uma vez, sem olhar os elementos
+	(void) sz;
+	const byte *it = (const byte*) first;
+	const byte *at = (const byte*) last;
 
-	// Novo array
-	byte *array = new byte[dis*sz];
+	// Novo array com o mesmo tamanho do intervalo original
+	byte *array = new byte[at-it];
 
-	while(it!=at)
-	{
-		// Copiando o valor de it para array
-		std::memcpy(array, it, sz);
-
-		// Proxima posicao
-		it += sz;
-		array += sz;
-	}
+	bulk::move( array, it, at-it, CopyMode::Auto );
 
 	return array;
 }
@@ -110,144 +234,125 @@ void *graal::clone( const void *first, const void *last, size_t sz )
 /// A funcao recebe um intervalo e retorna um ponteiro para o primeiro elemento encontrado que retornar true no predicado p
 const void *graal::find_if( const void *first, const void *last, size_t sz, Predicate p )
 {
-	const byte *it = (const byte*) first;
-	const byte *at = (const byte*) last;   
-
-	while(it!=at)
-	{
-		// Comparo se o valor de first eh true no predicado
-		if(p(it))
-			return it;
-
-		it += sz;
-	}
-
-	return at;
+	return detail::find_if( (const byte*) first, (const byte*) last, sz, p );
 }
 
 /// A funcao recebe um intervalo [first; last) e um elemento alvo, e retorna o primeiro ponteiro que for igual ao elemento alvo
 const void *graal::find( const void *first, const void *last, size_t sz,
 		const void *value, Equal eq )
 {
-	const byte *it = (const byte*) first;
-	const byte *at = (const byte*) last;
-	const byte *alvo = (const byte*) value;
-
-	while(it!=at)
-	{
-		// Comparo se o valor em it eh igual ao alvo
-		if(eq(it, alvo))
-		{
-			const byte *ret = it;
-			return ret;
-		}
-
-		it += sz;
-	}
-
-	return at;
+	// Comparo se o valor em it eh igual ao alvo
+	return detail::find_if( (const byte*) first, (const byte*) last, sz,
+			[value, eq]( const void *it ) { return eq(it, value); } );
 }
 
 /// A funcao retorna true quando o predicado p eh verdadeiro para todos os elementos do intervalo [first; last)
 bool graal::all_of( const void *first, const void *last, size_t sz, Predicate p )
 {
-	byte *it = (byte*) first;
-	byte *at = (byte*) last;
-
-	while(it!=at)
-	{
-		// Confere se o predicado de pelo menos um elemento eh falso, caso seja retorna false  
-		if(!p(it))
-			return false;
-
-		// Proxima posicao do array
-		it += sz;
-	}
-
-	// Caso o intervalo esteja vazio, retorna true
-	if((at-it)/sz==0)
-		return true;
-
-	// Retorna true caso para todos elementos o predicado seja true 
-	return true;
+	// Procura o primeiro elemento com predicado falso; intervalo vazio retorna true
+	return detail::find_if( (const byte*) first, (const byte*) last, sz,
+			[p]( const void *it ) { return !p(it); } ) == last;
 }
 
 /// A funcao retorna true quando o predicado p for verdadeiro para pelo menos um elemento do intervalo [first; last)
 bool graal::any_of( const void *first, const void *last, size_t sz, Predicate p )
 {
-	byte *it = (byte*) first;
-	byte *at = (byte*) last;
-
-	while(it!=at)
-	{
-		// Confere se o predicado de pelo menos um elemento eh true, caso seja retorna true  
-		if(p(it))
-			return true;
-
-		// Proxima posicao do array
-		it += sz;
-	}
-
-	// Caso o intervalo esteja vazio, retorna true
-	if((at-it)/sz==0)
-		return true;
-
-	// Retorna false caso para nenhum elemento do intervalo o predicado seja true 
-	return false;
+	// Intervalo vazio retorna false, pois nenhum elemento satisfaz o predicado
+	return detail::find_if( (const byte*) first, (const byte*) last, sz, p ) != last;
 }
 
 /// A funcao retorna true quando o predicado p nao retornar true para nenhum elemento do intervalo [first; last)
 bool graal::none_of( const void *first, const void *last, size_t sz, Predicate p )
 {
-	byte *it = (byte*) first;
-	byte *at = (byte*) last;
+	// Intervalo vazio retorna true
+	return detail::find_if( (const byte*) first, (const byte*) last, sz, p ) == last;
+}
 
-	while(it!=at)
-	{
-		// Confere se o predicado de pelo menos um elemento eh true, caso seja retorna false  
-		if(p(it))
-			return false;
+/// A funcao retorna o primeiro elemento de [first; last) para o qual o predicado em lote p eh verdadeiro
+const void *graal::find_if( const void *first, const void *last, size_t sz, BatchPredicate p )
+{
+	return find_lote( (const byte*) first, (const byte*) last, sz, p, true );
+}
 
-		// Proxima posicao do array
-		it += sz;
-	}
+/// A funcao retorna true quando o predicado em lote p eh verdadeiro para todos os elementos
+bool graal::all_of( const void *first, const void *last, size_t sz, BatchPredicate p )
+{
+	return find_lote( (const byte*) first, (const byte*) last, sz, p, false ) == last;
+}
 
-	// Caso o intervalo esteja vazio, retorna true
-	if((at-it)/sz==0)
-		return true;
+/// A funcao retorna true quando o predicado em lote p eh verdadeiro para pelo menos um elemento
+bool graal::any_of( const void *first, const void *last, size_t sz, BatchPredicate p )
+{
+	return find_lote( (const byte*) first, (const byte*) last, sz, p, true ) != last;
+}
+
+/// A funcao retorna true quando o predicado em lote p nao eh verdadeiro para nenhum elemento
+bool graal::none_of( const void *first, const void *last, size_t sz, BatchPredicate p )
+{
+	return find_lote( (const byte*) first, (const byte*) last, sz, p, true ) == last;
+}
 
-	// Retorna true caso para todos os elementos do intervalo o predicado nao seja true 
-	return true;
+/// A funcao retorna true se os elementos de [first1; last1) forem iguais aos correspondentes a partir de first2
+bool graal::equal( const void *first1, const void *last1, const void *first2, size_t sz, Equal eq )
+{
+	return mismatch( first1, last1, first2, sz, eq ).first == last1;
 }
 
-// TODO: equal
+/// A funcao retorna true se [first1; last1) e [first2; last2) tiverem o mesmo tamanho e elementos iguais
+bool graal::equal( const void *first1, const void *last1, const void *first2, const void *last2,
+		size_t sz, Equal eq )
+{
+	// Tamanhos diferentes: nao ha o que comparar
+	if((const byte*) last1 - (const byte*) first1 != (const byte*) last2 - (const byte*) first2)
+		return false;
+	return equal( first1, last1, first2, sz, eq );
+}
 
-// TODO: unique
+/// A funcao retorna o primeiro par de elementos correspondentes diferentes segundo eq
+std::pair< const void *, const void * > graal::mismatch( const void *first1, const void *last1,
+		const void *first2, size_t sz, Equal eq )
+{
+	const byte *it2 = (const byte*) first2;
+	const byte *it1 = detail::find_if( (const byte*) first1, (const byte*) last1, sz,
+			[&it2, sz, eq]( const byte *e )
+			{
+				bool diferente = !eq(e, it2);
+				it2 += diferente ? 0 : sz;
+				return diferente;
+			} );
+	return { it1, it2 };
+}
+
+/// A funcao retorna o primeiro par de elementos correspondentes diferentes, parando no fim do menor intervalo
+std::pair< const void *, const void * > graal::mismatch( const void *first1, const void *last1,
+		const void *first2, const void *last2, size_t sz, Equal eq )
+{
+	size_t n1 = (const byte*) last1 - (const byte*) first1;
+	size_t n2 = (const byte*) last2 - (const byte*) first2;
+	return mismatch( first1, (const byte*) first1 + (n1 < n2 ? n1 : n2), first2, sz, eq );
+}
 
 /// A funcao recebe um intervalo e reordena os elementos do intervalo de forma que todos os elementos que para o predicado p retornam true precedem os elementos que retornam false
 void *graal::partition( void *first, void *last, size_t sz, Predicate p )
 {
-	byte *aux = (byte*) first;
-	byte *it = (byte*) first;
-	byte *at = (byte*) last;
+	return kernels::despacha( sz, faz_partition<>{ (byte*) first, (byte*) last, p } );
+}
 
-	while(it!=at)
-	{
-		if(p(it))
-		{
-			// Variavel auxiliar para a troca
-			byte aux2[sz];
-			// Fazendo a troca dos elementos
-			std::memcpy(aux2, aux, sz);
-			std::memcpy(aux, it, sz);
-			std::memcpy(it, aux2, sz);
-
-			aux += sz;
-		}
-		// Proxima posicao do array
-		it += sz;
-	}
-	return aux;
+/// A funcao particiona [first; last) com o predicado p, trocando os elementos com ops
+void *graal::partition( void *first, void *last, size_t sz, Predicate p, const TypeOps &ops )
+{
+	return faz_partition<>{ (byte*) first, (byte*) last, p }( kernels::Operacoes{ &ops, sz } );
+}
+
+/// A funcao reordena [first; last) com os elementos cuja chave, lida do campo descrito por key, vem antes de value no inicio
+void *graal::partition( void *first, void *last, size_t sz, Key key, const void *value )
+{
+	return campos::despacha( key, faz_partition_campo{ (byte*) first, (byte*) last, sz, value } );
+}
+
+/// A funcao reordena [first, last) com os elementos para os quais o predicado em lote p eh verdadeiro no inicio
+void *graal::partition( void *first, void *last, size_t sz, BatchPredicate p )
+{
+	return kernels::despacha( sz, faz_partition_lote{ (byte*) first, (byte*) last, p } );
 }
 
-// TODO: sort
@@ -0,0 +1,152 @@
+#ifndef GRAAL_KERNELS
+#define GRAAL_KERNELS
+
+#include <cstring>
+#include <cstdint>
+#include "../include/graal.h"
+
+// Nucleos de troca (swap) e movimentacao de elementos de sz bytes.
+//
+// Em vez de chamar std::memcpy com um tamanho conhecido apenas em tempo de
+// execucao (tres chamadas por troca), o algoritmo escolhe uma vez, a partir
+// de sz, um nucleo cujo tamanho eh constante em tempo de compilacao. Assim os
+// memcpy viram simples loads/stores em registradores. Tipos que nao podem
+// ser movidos byte a byte usam o nucleo Operacoes, que chama as funcoes de
+// TypeOps dadas pelo usuario.
+
+namespace graal
+{
+	namespace kernels
+	{
+		using byte = detail::byte;
+
+		/// Elemento de exatamente N bytes
+		template < size_t N >
+		struct Fixo
+		{
+			size_t size() const { return N; }
+
+			void troca( void *a, void *b ) const
+			{
+				byte ta[N], tb[N];
+				std::memcpy(ta, a, N);
+				std::memcpy(tb, b, N);
+				std::memcpy(a, tb, N);
+				std::memcpy(b, ta, N);
+			}
+
+			void move( void *d, const void *s ) const
+			{
+				std::memcpy(d, s, N);
+			}
+		};
+
+		/// Elemento cujo tamanho eh multiplo de 8: trabalha com palavras de 64 bits
+		struct Palavras
+		{
+			size_t sz;
+
+			size_t size() const { return sz; }
+
+			void troca( void *a, void *b ) const
+			{
+				byte *x = (byte*) a;
+				byte *y = (byte*) b;
+				for(size_t i = 0; i < sz; i += 8)
+				{
+					std::uint64_t wx, wy;
+					std::memcpy(&wx, x+i, 8);
+					std::memcpy(&wy, y+i, 8);
+					std::memcpy(x+i, &wy, 8);
+					std::memcpy(y+i, &wx, 8);
+				}
+			}
+
+			void move( void *d, const void *s ) const
+			{
+				byte *x = (byte*) d;
+				const byte *y = (const byte*) s;
+				for(size_t i = 0; i < sz; i += 8)
+					std::memcpy(x+i, y+i, 8);
+			}
+		};
+
+		/// Caso geral (registros grandes ou de tamanho irregular): troca em blocos de 32 bytes
+		struct Blocos
+		{
+			size_t sz;
+
+			size_t size() const { return sz; }
+
+			void troca( void *a, void *b ) const
+			{
+				byte *x = (byte*) a;
+				byte *y = (byte*) b;
+				size_t i = 0;
+
+				for(; i+32 <= sz; i += 32)
+					Fixo< 32 >().troca(x+i, y+i);
+
+				// Bytes restantes do final do elemento
+				for(; i < sz; ++i)
+				{
+					byte t = x[i];
+					x[i] = y[i];
+					y[i] = t;
+				}
+			}
+
+			void move( void *d, const void *s ) const
+			{
+				std::memcpy(d, s, sz);
+			}
+		};
+
+		/// Elemento com operacoes proprias: troca e move chamam as funcoes de TypeOps
+		struct Operacoes
+		{
+			const TypeOps *ops;
+			size_t sz;
+
+			size_t size() const { return sz; }
+
+			void troca( void *a, void *b ) const
+			{
+				if(a!=b)
+					ops->swap(a, b);
+			}
+
+			/// d precisa ser um objeto vivo: eh uma atribuicao, nao uma construcao
+			void move( void *d, const void *s ) const
+			{
+				if(d!=s)
+					ops->move_assign(d, const_cast< void * >(s));
+			}
+		};
+
+		/* sz: tamanho em bytes de cada elemento;
+		 * f: objeto com operator() template que recebe o nucleo escolhido;
+		 * Retorna o que f retornar. O nucleo eh escolhido uma unica vez por chamada
+		 * do algoritmo, e nao uma vez por elemento.
+		 */
+		template < typename F >
+		auto despacha( size_t sz, F f ) -> decltype( f( Fixo< 1 >() ) )
+		{
+			switch(sz)
+			{
+				case 1:  return f( Fixo< 1 >() );
+				case 2:  return f( Fixo< 2 >() );
+				case 4:  return f( Fixo< 4 >() );
+				case 8:  return f( Fixo< 8 >() );
+				case 16: return f( Fixo< 16 >() );
+				case 32: return f( Fixo< 32 >() );
+			}
+
+			if(sz % 8 == 0)
+				return f( Palavras{ sz } );
+
+			return f( Blocos{ sz } );
+		}
+	}
+}
+#endif
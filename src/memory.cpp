@@ -0,0 +1,151 @@
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include "../include/graal.h"
+#include "bulk.h"
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Alocador do heap do sistema, com alinhamento pedido por quem chama
+	class Heap : public graal::Allocator
+	{
+		public:
+			void *allocate( size_t bytes, size_t align ) override
+			{
+				void *p = nullptr;
+				if(align < sizeof(void*))
+					align = sizeof(void*);
+				if(posix_memalign(&p, align, bytes ? bytes : 1) != 0)
+					throw std::bad_alloc();
+				return p;
+			}
+
+			void deallocate( void *p, size_t ) override
+			{
+				std::free(p);
+			}
+	};
+}
+
+/// Alocador que usa o heap do sistema
+graal::Allocator &graal::default_allocator()
+{
+	static Heap heap;
+	return heap;
+}
+
+// ============================================================================
+//  Arena
+// ============================================================================
+
+graal::Arena::Arena( size_t block, Allocator &upstream )
+	: m_upstream( upstream ), m_block( block ), m_atual( 0 ), m_ocupado( 0 ), m_usado( 0 )
+{}
+
+graal::Arena::~Arena()
+{
+	for(auto &b : m_blocos)
+		m_upstream.deallocate(b.inicio, b.tamanho);
+}
+
+/// Avanca o deslocamento no bloco atual, passando para o proximo bloco quando nao cabe
+void *graal::Arena::allocate( size_t bytes, size_t align )
+{
+	while(m_atual < m_blocos.size())
+	{
+		Bloco &b = m_blocos[m_atual];
+		std::uintptr_t base = (std::uintptr_t) b.inicio;
+		std::uintptr_t p = (base + m_ocupado + align-1) & ~(std::uintptr_t)(align-1);
+
+		if(p + bytes <= base + b.tamanho)
+		{
+			m_usado += (p + bytes) - (base + m_ocupado);
+			m_ocupado = (p + bytes) - base;
+			return (void*) p;
+		}
+
+		// Bloco sem espaco: segue para o proximo ja existente
+		++m_atual;
+		m_ocupado = 0;
+	}
+
+	// Nenhum bloco serve: pede um novo, grande o bastante para o pedido
+	size_t tamanho = bytes + align > m_block ? bytes + align : m_block;
+	Bloco novo{ m_upstream.allocate(tamanho, CACHE_LINE), tamanho };
+	m_blocos.push_back(novo);
+	m_atual = m_blocos.size()-1;
+	m_ocupado = 0;
+
+	return allocate(bytes, align);
+}
+
+/// Volta para o inicio do primeiro bloco; os blocos continuam reservados
+void graal::Arena::reset()
+{
+	m_atual = 0;
+	m_ocupado = 0;
+	m_usado = 0;
+}
+
+/// Bytes alocados desde o ultimo reset, incluindo o preenchimento de alinhamento
+size_t graal::Arena::used() const
+{
+	return m_usado;
+}
+
+/// Arena da thread que chama, criada no primeiro uso
+graal::Arena &graal::Arena::local()
+{
+	static thread_local Arena arena;
+	return arena;
+}
+
+// ============================================================================
+//  Buffer
+// ============================================================================
+
+graal::Buffer::Buffer( Allocator &alloc, size_t bytes )
+	: m_data( alloc.allocate(bytes, CACHE_LINE) ), m_size( bytes ), m_alloc( &alloc )
+{}
+
+graal::Buffer::~Buffer()
+{
+	if(m_data)
+		m_alloc->deallocate(m_data, m_size);
+}
+
+graal::Buffer::Buffer( Buffer &&o )
+	: m_data( o.m_data ), m_size( o.m_size ), m_alloc( o.m_alloc )
+{
+	o.m_data = nullptr;
+	o.m_size = 0;
+}
+
+graal::Buffer &graal::Buffer::operator=( Buffer &&o )
+{
+	if(this != &o)
+	{
+		if(m_data)
+			m_alloc->deallocate(m_data, m_size);
+
+		m_data = o.m_data;
+		m_size = o.m_size;
+		m_alloc = o.m_alloc;
+		o.m_data = nullptr;
+		o.m_size = 0;
+	}
+	return *this;
+}
+
+/// A funcao copia o intervalo [first; last) para um Buffer obtido de alloc
+graal::Buffer graal::clone( const void *first, const void *last, size_t, Allocator &alloc )
+{
+	size_t n = (const byte*) last - (const byte*) first;
+	Buffer copia( alloc, n );
+
+	bulk::move( copia.data(), first, n, CopyMode::Auto );
+
+	return copia;
+}
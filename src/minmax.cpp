@@ -0,0 +1,247 @@
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include "../include/graal.h"
+#include "simd.h"
+#include "campo.h"
+
+// Nucleos de min/max/minmax para tipos primitivos.
+//
+// O intervalo eh percorrido em blocos que cabem na cache L1. Para cada bloco
+// os extremos sao reduzidos com vetores (extensoes vetoriais do GCC, que viram
+// SSE2 ou AVX2 conforme a funcao que as instancia). Somente quando o bloco
+// contem um valor estritamente melhor que o atual ele eh relido, ainda na L1,
+// para achar a primeira posicao desse valor. Assim a memoria eh lida uma vez
+// e a primeira ocorrencia eh preservada.
+
+#define GRAAL_SEMPRE_INLINE inline __attribute__((always_inline))
+
+namespace
+{
+	/// Bytes por bloco: pequeno o bastante para a releitura acontecer na L1
+	const size_t BLOCO = 4096;
+
+	/// Falso apenas para NaN; para inteiros eh sempre verdadeiro
+	template < typename T >
+	GRAAL_SEMPRE_INLINE bool valido( T x ) { return x == x; }
+
+	/// Extremos de um bloco de n elementos, n multiplo de W/sizeof(T)
+	template < typename T, size_t W, bool Menor, bool Maior >
+	GRAAL_SEMPRE_INLINE void reduz( const T *p, size_t n, T &vmin, T &vmax )
+	{
+		typedef T V __attribute__((vector_size(W)));
+		const size_t L = W/sizeof(T);
+
+		// Vetores iniciados com o melhor valor atual: NaN nunca eh < ou >,
+		// entao eh ignorado pela selecao abaixo
+		V mn = V{} + vmin;
+		V mx = V{} + vmax;
+
+		for(size_t i = 0; i < n; i += L)
+		{
+			V x;
+			std::memcpy(&x, p+i, W);
+			if(Menor) mn = x < mn ? x : mn;
+			if(Maior) mx = x > mx ? x : mx;
+		}
+
+		for(size_t k = 0; k < L; ++k)
+		{
+			if(Menor && mn[k] < vmin) vmin = mn[k];
+			if(Maior && mx[k] > vmax) vmax = mx[k];
+		}
+	}
+
+	/// Primeiro elemento de [it, last) igual a v (existe, pois v veio do bloco)
+	template < typename T >
+	GRAAL_SEMPRE_INLINE const T *localiza( const T *it, T v )
+	{
+		while(!(*it == v))
+			++it;
+		return it;
+	}
+
+	/* first, last: intervalo nao vazio;
+	 * imin, imax: recebem a primeira ocorrencia do menor e do maior elemento.
+	 */
+	template < typename T, size_t W, bool Menor, bool Maior >
+	GRAAL_SEMPRE_INLINE void varre( const T *first, const T *last, const T *&imin, const T *&imax )
+	{
+		const size_t L = W/sizeof(T);
+		const size_t B = BLOCO/sizeof(T);
+
+		// NaN no inicio nao pode ser o valor de partida
+		const T *it = first;
+		while(it!=last && !valido(*it))
+			++it;
+
+		imin = imax = (it==last) ? first : it;
+		if(it==last)
+			return;
+
+		T vmin = *it, vmax = *it;
+		++it;
+
+		while(it!=last)
+		{
+			size_t n = (size_t)(last-it) < B ? (size_t)(last-it) : B;
+			size_t nv = n - n%L;
+			T bmin = vmin, bmax = vmax;
+
+			reduz< T, W, Menor, Maior >(it, nv, bmin, bmax);
+
+			// Final do intervalo que nao completa um vetor
+			for(size_t i = nv; i < n; ++i)
+			{
+				if(Menor && it[i] < bmin) bmin = it[i];
+				if(Maior && it[i] > bmax) bmax = it[i];
+			}
+
+			if(Menor && bmin < vmin)
+			{
+				imin = localiza(it, bmin);
+				vmin = bmin;
+			}
+			if(Maior && bmax > vmax)
+			{
+				imax = localiza(it, bmax);
+				vmax = bmax;
+			}
+
+			it += n;
+		}
+	}
+
+	template < typename T, bool Menor, bool Maior >
+	void varre_sse2( const T *first, const T *last, const T *&imin, const T *&imax )
+	{
+		varre< T, 16, Menor, Maior >(first, last, imin, imax);
+	}
+
+#ifdef GRAAL_X86
+	template < typename T, bool Menor, bool Maior >
+	GRAAL_AVX2 void varre_avx2( const T *first, const T *last, const T *&imin, const T *&imax )
+	{
+		varre< T, 32, Menor, Maior >(first, last, imin, imax);
+	}
+#endif
+
+	/// Escolhe o nucleo conforme a CPU; intervalo vazio retorna (last, last)
+	template < typename T, bool Menor, bool Maior >
+	std::pair< const void *, const void * > extremos( const void *first, const void *last )
+	{
+		const T *f = (const T*) first;
+		const T *l = (const T*) last;
+		const T *imin = l, *imax = l;
+
+		if(f!=l)
+		{
+#ifdef GRAAL_X86
+			if(graal::simd::tem_avx2())
+				varre_avx2< T, Menor, Maior >(f, l, imin, imax);
+			else
+#endif
+				varre_sse2< T, Menor, Maior >(f, l, imin, imax);
+		}
+
+		return std::make_pair( (const void*) imin, (const void*) imax );
+	}
+
+	/// Instancia extremos para o tipo descrito por type, que deve ter sz bytes
+	template < bool Menor, bool Maior >
+	std::pair< const void *, const void * > despacha( const void *first, const void *last,
+			size_t sz, graal::ElementType type )
+	{
+		using graal::ElementType;
+
+		if(sz != graal::element_size(type))
+			throw std::invalid_argument( "graal: sz difere do tamanho de ElementType" );
+
+		switch(type)
+		{
+			case ElementType::Int8:   return extremos< std::int8_t, Menor, Maior >(first, last);
+			case ElementType::UInt8:  return extremos< std::uint8_t, Menor, Maior >(first, last);
+			case ElementType::Int16:  return extremos< std::int16_t, Menor, Maior >(first, last);
+			case ElementType::UInt16: return extremos< std::uint16_t, Menor, Maior >(first, last);
+			case ElementType::Int32:  return extremos< std::int32_t, Menor, Maior >(first, last);
+			case ElementType::UInt32: return extremos< std::uint32_t, Menor, Maior >(first, last);
+			case ElementType::Int64:  return extremos< std::int64_t, Menor, Maior >(first, last);
+			case ElementType::UInt64: return extremos< std::uint64_t, Menor, Maior >(first, last);
+			case ElementType::Float:  return extremos< float, Menor, Maior >(first, last);
+			case ElementType::Double: return extremos< double, Menor, Maior >(first, last);
+		}
+		return std::make_pair( last, last );
+	}
+
+	/// Elementos por bloco em menor_campo
+	const size_t BLOCO_CAMPO = 64;
+
+	/* min pelo campo de registros de sz bytes, com a mesma ideia dos nucleos
+	 * acima: o menor valor de cada bloco eh reduzido sem desvios e o bloco so
+	 * eh relido, para achar a posicao, quando melhora o menor atual.
+	 */
+	struct menor_campo
+	{
+		const unsigned char *first, *last;
+		size_t sz;
+
+		template < typename U >
+		const void *operator()( graal::campos::LeCampo< U > ler ) const
+		{
+			if(first==last)
+				return last;
+
+			const unsigned char *menor = first;
+			U v = ler(first);
+			size_t n = (last-first) / sz;
+
+			for(const unsigned char *it = first; n > 0; )
+			{
+				size_t m = n < BLOCO_CAMPO ? n : BLOCO_CAMPO;
+				U b = ler(it);
+				for(size_t j = 1; j < m; ++j)
+				{
+					U x = ler(it + j*sz);
+					b = x < b ? x : b;
+				}
+
+				if(b < v)
+				{
+					v = b;
+					menor = it;
+					while(ler(menor) != b)
+						menor += sz;
+				}
+				it += m*sz;
+				n -= m;
+			}
+			return menor;
+		}
+	};
+}
+
+/// A funcao retorna a primeira ocorrencia do menor elemento de um intervalo de tipo primitivo
+const void *graal::min( const void *first, const void *last, size_t sz, ElementType type )
+{
+	return despacha< true, false >(first, last, sz, type).first;
+}
+
+/// A funcao retorna a primeira ocorrencia do maior elemento de um intervalo de tipo primitivo
+const void *graal::max( const void *first, const void *last, size_t sz, ElementType type )
+{
+	return despacha< false, true >(first, last, sz, type).second;
+}
+
+/// A funcao retorna, em uma unica passada, a primeira ocorrencia do menor e do maior elemento
+std::pair< const void *, const void * > graal::minmax( const void *first, const void *last,
+		size_t sz, ElementType type )
+{
+	return despacha< true, true >(first, last, sz, type);
+}
+
+/// A funcao retorna a primeira ocorrencia do elemento com a menor chave, lida do campo descrito por key
+const void *graal::min( const void *first, const void *last, size_t sz, Key key )
+{
+	return campos::despacha( key, menor_campo{ (const unsigned char*) first, (const unsigned char*) last, sz } );
+}
@@ -0,0 +1,118 @@
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include "../include/graal.h"
+#include "simd.h"
+
+// equal e mismatch bit a bit.
+//
+// equal compara o intervalo inteiro com um unico memcmp, que ja eh vetorizado
+// pela biblioteca C. mismatch precisa da posicao da diferenca: os dois
+// intervalos sao comparados byte a byte com SSE2/AVX2 ate o primeiro byte
+// diferente, e o resultado volta para o inicio do elemento que o contem.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Primeiro indice i < n com a[i] != b[i], ou n
+	size_t difere_escalar( const byte *a, const byte *b, size_t i, size_t n )
+	{
+		for(; i+8 <= n; i += 8)
+		{
+			std::uint64_t x, y;
+			std::memcpy(&x, a+i, 8);
+			std::memcpy(&y, b+i, 8);
+			if(x!=y)
+				break;
+		}
+		while(i < n && a[i]==b[i])
+			++i;
+		return i;
+	}
+
+#ifdef GRAAL_X86
+	/// Compara com SSE2, 32 bytes por iteracao
+	size_t difere_sse2( const byte *a, const byte *b, size_t i, size_t n )
+	{
+		for(; i+32 <= n; i += 32)
+		{
+			__m128i c0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (a+i)), _mm_loadu_si128((const __m128i*) (b+i)));
+			__m128i c1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (a+i+16)), _mm_loadu_si128((const __m128i*) (b+i+16)));
+			unsigned m = (unsigned) _mm_movemask_epi8(c0) | ((unsigned) _mm_movemask_epi8(c1) << 16);
+
+			// Bits em 0 marcam os bytes diferentes; o menos significativo eh o primeiro
+			if(m != 0xFFFFFFFFu)
+				return i + __builtin_ctz(~m);
+		}
+		return difere_escalar(a, b, i, n);
+	}
+
+	/// Compara com AVX2, 64 bytes por iteracao
+	GRAAL_AVX2 size_t difere_avx2( const byte *a, const byte *b, size_t i, size_t n )
+	{
+		for(; i+64 <= n; i += 64)
+		{
+			__m256i c0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (a+i)), _mm256_loadu_si256((const __m256i*) (b+i)));
+			__m256i c1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (a+i+32)), _mm256_loadu_si256((const __m256i*) (b+i+32)));
+			std::uint64_t m = (std::uint32_t) _mm256_movemask_epi8(c0)
+				| ((std::uint64_t) (std::uint32_t) _mm256_movemask_epi8(c1) << 32);
+
+			if(~m)
+				return i + __builtin_ctzll(~m);
+		}
+		return difere_sse2(a, b, i, n);
+	}
+#endif
+
+	/// Primeiro byte diferente entre a e b nos n primeiros, ou n
+	size_t difere( const byte *a, const byte *b, size_t n )
+	{
+#ifdef GRAAL_X86
+		if(graal::simd::tem_avx2())
+			return difere_avx2(a, b, 0, n);
+		return difere_sse2(a, b, 0, n);
+#else
+		return difere_escalar(a, b, 0, n);
+#endif
+	}
+}
+
+/// A funcao retorna true se os bytes de [first1; last1) forem iguais aos bytes a partir de first2
+bool graal::equal( const void *first1, const void *last1, const void *first2, size_t sz, Bitwise )
+{
+	// Os intervalos sao comparados como bytes, sem olhar os elementos
+	(void) sz;
+	size_t n = (const byte*) last1 - (const byte*) first1;
+	return n == 0 || std::memcmp(first1, first2, n) == 0;
+}
+
+/// A funcao retorna true se os dois intervalos tiverem o mesmo tamanho e os mesmos bytes
+bool graal::equal( const void *first1, const void *last1, const void *first2, const void *last2,
+		size_t sz, Bitwise )
+{
+	if((const byte*) last1 - (const byte*) first1 != (const byte*) last2 - (const byte*) first2)
+		return false;
+	return equal( first1, last1, first2, sz, bitwise );
+}
+
+/// A funcao retorna o primeiro par de elementos correspondentes com bytes diferentes
+std::pair< const void *, const void * > graal::mismatch( const void *first1, const void *last1,
+		const void *first2, size_t sz, Bitwise )
+{
+	size_t n = (const byte*) last1 - (const byte*) first1;
+	size_t i = difere( (const byte*) first1, (const byte*) first2, n );
+
+	// Volta para o inicio do elemento que contem o byte diferente
+	i -= i % sz;
+	return { (const byte*) first1 + i, (const byte*) first2 + i };
+}
+
+/// A funcao retorna o primeiro par de elementos com bytes diferentes, parando no fim do menor intervalo
+std::pair< const void *, const void * > graal::mismatch( const void *first1, const void *last1,
+		const void *first2, const void *last2, size_t sz, Bitwise )
+{
+	size_t n1 = (const byte*) last1 - (const byte*) first1;
+	size_t n2 = (const byte*) last2 - (const byte*) first2;
+	return mismatch( first1, (const byte*) first1 + (n1 < n2 ? n1 : n2), first2, sz, bitwise );
+}
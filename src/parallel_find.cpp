@@ -0,0 +1,152 @@
+#include <atomic>
+#include "../include/graal.h"
+#include "threads.h"
+
+// Buscas paralelas com parada antecipada.
+//
+// O intervalo eh dividido em pedacos de BYTES_POR_PEDACO, que as threads
+// pegam em ordem crescente de um contador atomico. Quem acha um elemento
+// registra seu indice em melhor (o menor visto ate agora). Uma thread so
+// pega um pedaco que comeca antes de melhor, entao todos os pedacos antes
+// da primeira ocorrencia sao percorridos por inteiro e o resultado eh o
+// mesmo da busca sequencial. Nos quantificadores (any_of, all_of, none_of)
+// qualquer ocorrencia basta, e todas as threads param na primeira.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Tamanho de cada pedaco pego por uma thread: intervalo entre verificacoes de parada
+	const size_t BYTES_POR_PEDACO = 16*1024;
+
+	/// Guarda i em melhor se for menor que o valor atual
+	inline void menor( std::atomic< size_t > &melhor, size_t i )
+	{
+		size_t atual = melhor.load(std::memory_order_relaxed);
+		while(i < atual && !melhor.compare_exchange_weak(atual, i, std::memory_order_relaxed));
+	}
+
+	/* Procura com busca(a, b), que retorna o primeiro elemento achado em [a, b)
+	 * ou b, usando T threads. qualquer: basta uma ocorrencia, nao a primeira.
+	 */
+	template < typename Busca >
+	const byte *procura( const byte *first, const byte *last, size_t sz, Busca busca,
+			unsigned T, bool qualquer )
+	{
+		const size_t n = (last-first) / sz;
+		const size_t pedaco = BYTES_POR_PEDACO/sz > 0 ? BYTES_POR_PEDACO/sz : 1;
+
+		std::atomic< size_t > proximo( 0 );
+		std::atomic< size_t > melhor( n );
+
+		graal::threads::executa(T, [&]( unsigned )
+		{
+			for(;;)
+			{
+				size_t ini = proximo.fetch_add(pedaco, std::memory_order_relaxed);
+				size_t limite = melhor.load(std::memory_order_relaxed);
+				if(ini >= limite || (qualquer && limite != n))
+					return;
+
+				size_t fim = ini+pedaco < n ? ini+pedaco : n;
+				const byte *a = first + ini*sz;
+				const byte *b = first + fim*sz;
+				const byte *r = busca(a, b);
+				if(r!=b)
+				{
+					// Os pedacos seguintes nao podem ter uma ocorrencia anterior
+					menor(melhor, (r-first) / sz);
+					return;
+				}
+			}
+		});
+
+		return first + melhor.load()*sz;
+	}
+
+	/// Numero de threads a usar, ou 1 se o intervalo for pequeno demais
+	unsigned quantas( const void *first, const void *last, size_t sz, unsigned threads, size_t threshold )
+	{
+		size_t n = ((const byte*) last - (const byte*) first) / sz;
+		if(n < threshold)
+			return 1;
+		return graal::threads::quantas(threads);
+	}
+
+	/// Existe elemento em [first, last) com p(elemento) == valor, procurando com T threads
+	bool existe( const void *first, const void *last, size_t sz, graal::Predicate p, bool valor,
+			unsigned T )
+	{
+		const byte *at = (const byte*) last;
+		return procura( (const byte*) first, at, sz, [sz, p, valor]( const byte *a, const byte *b )
+				{
+					return graal::detail::find_if(a, b, sz, [p, valor]( const byte *e ) { return p(e) == valor; });
+				}, T, true )!=at;
+	}
+}
+
+/// A funcao retorna o primeiro elemento de [first, last) para o qual p eh verdadeiro, procurando com varias threads
+const void *graal::parallel_find_if( const void *first, const void *last, size_t sz, Predicate p,
+		unsigned threads, size_t threshold )
+{
+	unsigned T = quantas(first, last, sz, threads, threshold);
+	if(T < 2)
+		return find_if(first, last, sz, p);
+
+	return procura( (const byte*) first, (const byte*) last, sz, [sz, p]( const byte *a, const byte *b )
+			{ return detail::find_if(a, b, sz, p); }, T, false );
+}
+
+/// A funcao retorna o primeiro elemento de [first, last) igual a value segundo eq, procurando com varias threads
+const void *graal::parallel_find( const void *first, const void *last, size_t sz,
+		const void *value, Equal eq, unsigned threads, size_t threshold )
+{
+	unsigned T = quantas(first, last, sz, threads, threshold);
+	if(T < 2)
+		return find(first, last, sz, value, eq);
+
+	return procura( (const byte*) first, (const byte*) last, sz, [sz, value, eq]( const byte *a, const byte *b )
+			{ return (const byte*) find(a, b, sz, value, eq); }, T, false );
+}
+
+/// A funcao retorna o primeiro elemento de [first, last) com os mesmos bytes de value, procurando com varias threads
+const void *graal::parallel_find( const void *first, const void *last, size_t sz,
+		const void *value, Bitwise, unsigned threads, size_t threshold )
+{
+	unsigned T = quantas(first, last, sz, threads, threshold);
+	if(T < 2)
+		return find(first, last, sz, value, bitwise);
+
+	return procura( (const byte*) first, (const byte*) last, sz, [sz, value]( const byte *a, const byte *b )
+			{ return (const byte*) find(a, b, sz, value, bitwise); }, T, false );
+}
+
+/// A funcao retorna true se p for verdadeiro para algum elemento; as threads param na primeira ocorrencia
+bool graal::parallel_any_of( const void *first, const void *last, size_t sz, Predicate p,
+		unsigned threads, size_t threshold )
+{
+	unsigned T = quantas(first, last, sz, threads, threshold);
+	if(T < 2)
+		return any_of(first, last, sz, p);
+	return existe(first, last, sz, p, true, T);
+}
+
+/// A funcao retorna true se p for verdadeiro para todos os elementos; as threads param no primeiro falso
+bool graal::parallel_all_of( const void *first, const void *last, size_t sz, Predicate p,
+		unsigned threads, size_t threshold )
+{
+	unsigned T = quantas(first, last, sz, threads, threshold);
+	if(T < 2)
+		return all_of(first, last, sz, p);
+	return !existe(first, last, sz, p, false, T);
+}
+
+/// A funcao retorna true se p for falso para todos os elementos; as threads param no primeiro verdadeiro
+bool graal::parallel_none_of( const void *first, const void *last, size_t sz, Predicate p,
+		unsigned threads, size_t threshold )
+{
+	unsigned T = quantas(first, last, sz, threads, threshold);
+	if(T < 2)
+		return none_of(first, last, sz, p);
+	return !existe(first, last, sz, p, true, T);
+}
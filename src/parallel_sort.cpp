@@ -0,0 +1,231 @@
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "sort.h"
+#include "bulk.h"
+#include "threads.h"
+
+// Sample sort paralelo.
+//
+// 1. Uma amostra espalhada pelo intervalo eh ordenada e dela saem B-1
+//    separadores, que dividem os valores em B baldes.
+// 2. Cada thread classifica seu pedaco do intervalo (busca binaria nos
+//    separadores), guardando o balde de cada elemento e contando os baldes.
+//    Um valor que ocupa mais de um separador eh frequente: os elementos
+//    iguais a ele vao para um balde de igualdade proprio.
+// 3. Com as contagens, cada thread sabe onde escrever cada balde e espalha
+//    seus elementos no buffer auxiliar, sem sincronizacao.
+// 4. As threads pegam baldes de uma fila (maiores primeiro), ordenam cada um
+//    com pdqsort e copiam o resultado de volta para o array. Os baldes de
+//    igualdade ja estao ordenados e so sao copiados.
+//
+// A memoria eh percorrida poucas vezes e cada fase eh independente entre as
+// threads, o que permite escalar com o numero de nucleos ate o limite de
+// banda de memoria. Uma chave muito repetida custa uma passada, sem
+// concentrar a ordenacao de um balde grande em uma thread so.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Elementos amostrados por balde
+	const size_t AMOSTRAS_POR_BALDE = 16;
+
+	/// Maximo de baldes: com os de igualdade, o balde de cada elemento cabe em um byte
+	const size_t MAX_BALDES = 128;
+
+	/// Elementos ate este tamanho usam um temporario na pilha
+	const size_t TMP_PILHA = 256;
+
+	/// pdqsort com um temporario proprio, para ser chamado de qualquer thread
+	template < typename K >
+	void ordena( byte *first, byte *last, K k, graal::Compare cmp )
+	{
+		byte pilha[TMP_PILHA];
+		graal::Buffer heap;
+		byte *tmp = pilha;
+		if(k.size() > TMP_PILHA)
+		{
+			heap = graal::Buffer( graal::default_allocator(), k.size() );
+			tmp = heap.as< byte >();
+		}
+		graal::sort::pdqsort(first, last, k, cmp, tmp);
+	}
+
+	struct faz_sample_sort
+	{
+		byte *first;
+		size_t n;
+		graal::Compare cmp;
+		unsigned T;
+		graal::Allocator *alloc;
+
+		template < typename K >
+		void operator()( K k ) const
+		{
+			const size_t sz = k.size();
+
+			// Potencia de 2 com cerca de 4 baldes por thread, para equilibrar a fase 4
+			size_t B = 2;
+			while(B < 4*(size_t) T && B < MAX_BALDES)
+				B *= 2;
+
+			// 1. Amostra e separadores
+			size_t s = std::min(n, B*AMOSTRAS_POR_BALDE);
+			graal::Buffer amostra( *alloc, s*sz );
+			byte *am = amostra.as< byte >();
+			std::uint64_t semente = 0x9e3779b97f4a7c15ull;
+			for(size_t i = 0; i < s; ++i)
+			{
+				// Posicao no i-esimo trecho de n/s elementos, deslocada por um gerador simples
+				semente = semente * 6364136223846793005ull + 1442695040888963407ull;
+				size_t j = i*(n/s) + (size_t)(semente >> 33) % (n/s);
+				k.move(am + i*sz, first + j*sz);
+			}
+			ordena(am, am + s*sz, k, cmp);
+
+			std::vector< const byte * > sep( B-1 );
+			for(size_t b = 0; b+1 < B; ++b)
+				sep[b] = am + ((b+1)*s/B)*sz;
+
+			// Os elementos iguais a um separador vao para o balde a sua direita.
+			// Se o separador repete o anterior, o valor eh frequente, e os
+			// iguais a ele formam o balde de igualdade 2b-1, antes do balde
+			// 2b com os maiores que ele. Os baldes ficam em [0, 2B-1).
+			std::vector< char > frequente( B, 0 );
+			bool algum = false;
+			for(size_t b = 2; b < B; ++b)
+			{
+				frequente[b] = !cmp(sep[b-2], sep[b-1]);
+				algum = algum || frequente[b];
+			}
+			const size_t NB = 2*B - 1;
+
+			// 2. Classificacao: balde de cada elemento e contagem por thread
+			graal::Buffer aux( *alloc, n*sz + n );
+			byte *scratch = aux.as< byte >();
+			std::uint8_t *balde = (std::uint8_t*) (scratch + n*sz);
+			std::vector< size_t > cont( T*NB, 0 );
+
+			auto pedaco = [this]( unsigned t, size_t &ini, size_t &fim )
+			{
+				ini = n*t/T;
+				fim = n*(t+1)/T;
+			};
+
+			graal::threads::executa(T, [&]( unsigned t )
+			{
+				size_t ini, fim;
+				pedaco(t, ini, fim);
+				size_t *c = &cont[t*NB];
+
+				// Copias locais: cmp eh opaco e obrigaria a reler tudo a cada chamada
+				const graal::Compare menor = cmp;
+				const byte *const base = first;
+				const byte *const *S = sep.data();
+				const char *F = frequente.data();
+				const bool igualdade = algum;
+				const size_t meio = B/2;
+
+				for(size_t i = ini; i < fim; ++i)
+				{
+					const byte *e = base + i*sz;
+					size_t b = 0;
+
+					// Quantidade de separadores <= e
+					for(size_t passo = meio; passo > 0; passo /= 2)
+						if(!menor(e, S[b+passo-1]))
+							b += passo;
+
+					// e >= sep[b-1]: com valores frequentes, testa a igualdade
+					// sempre e sem desvio, que sairia caro ao errar a previsao
+					size_t id = 2*b;
+					if(igualdade)
+						id -= (size_t) (F[b] & !menor(S[b - (b > 0)], e));
+
+					balde[i] = (std::uint8_t) id;
+					++c[id];
+				}
+			});
+
+			// 3. Posicao de escrita de cada (thread, balde) e espalhamento
+			std::vector< size_t > inicio( NB+1, 0 );
+			std::vector< size_t > pos( T*NB );
+			for(size_t b = 0; b < NB; ++b)
+			{
+				size_t soma = inicio[b];
+				for(unsigned t = 0; t < T; ++t)
+				{
+					pos[t*NB+b] = soma;
+					soma += cont[t*NB+b];
+				}
+				inicio[b+1] = soma;
+			}
+
+			graal::threads::executa(T, [&]( unsigned t )
+			{
+				size_t ini, fim;
+				pedaco(t, ini, fim);
+				size_t *p = &pos[t*NB];
+
+				for(size_t i = ini; i < fim; ++i)
+					k.move(scratch + (p[balde[i]]++)*sz, first + i*sz);
+			});
+
+			// 4. Ordena os baldes, maiores primeiro, e copia de volta. Os de
+			// igualdade so sao copiados, em pedacos, para que um valor muito
+			// frequente nao fique com uma thread so
+			struct Tarefa
+			{
+				size_t ini, fim;
+				bool ordena;
+			};
+			const size_t copia = std::max< size_t >(n / (4*T), 1);
+			std::vector< Tarefa > fila;
+			for(size_t b = 0; b < NB; ++b)
+			{
+				if(b % 2 == 0)
+					fila.push_back(Tarefa{ inicio[b], inicio[b+1], true });
+				else
+					for(size_t i = inicio[b]; i < inicio[b+1]; i += copia)
+						fila.push_back(Tarefa{ i, std::min(i + copia, inicio[b+1]), false });
+			}
+			// As copias, baratas, ficam no fim para preencher as threads ociosas
+			std::sort(fila.begin(), fila.end(), []( const Tarefa &a, const Tarefa &b )
+				{ return a.ordena != b.ordena ? a.ordena : a.fim-a.ini > b.fim-b.ini; });
+
+			std::atomic< size_t > proximo( 0 );
+			graal::threads::executa(T, [&]( unsigned )
+			{
+				for(size_t i; (i = proximo.fetch_add(1)) < fila.size(); )
+				{
+					const Tarefa &f = fila[i];
+					byte *ini = scratch + f.ini*sz;
+					byte *fim = scratch + f.fim*sz;
+					if(f.ordena)
+						ordena(ini, fim, k, cmp);
+					graal::bulk::move(first + f.ini*sz, ini, fim-ini, graal::CopyMode::Cached);
+				}
+			});
+		}
+	};
+}
+
+/// A funcao ordena os count elementos a partir de first de acordo com cmp, usando varias threads
+void graal::parallel_qsort( void *first, size_t count, size_t sz, Compare cmp,
+		unsigned threads, size_t threshold, Allocator &alloc )
+{
+	unsigned T = threads::quantas(threads);
+
+	// Intervalos pequenos: o custo de criar threads nao compensa
+	if(T < 2 || count < threshold || count < 2*MAX_BALDES*AMOSTRAS_POR_BALDE)
+	{
+		graal::qsort(first, count, sz, cmp);
+		return;
+	}
+
+	kernels::despacha( sz, faz_sample_sort{ (byte*) first, count, cmp, T, &alloc } );
+}
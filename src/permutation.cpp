@@ -0,0 +1,211 @@
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "sort.h"
+
+// Ordenacao indireta e aplicacao de permutacoes.
+//
+// argsort ordena um array de indices (4 ou 8 bytes cada) com pdqsort,
+// comparando os registros para os quais os indices apontam. Com registros
+// grandes, as trocas da ordenacao movem so os indices; os registros sao
+// movidos uma unica vez depois, por apply_permutation.
+//
+// apply_permutation segue os ciclos da permutacao: o primeiro registro de
+// cada ciclo vai para um temporario, cada posicao do ciclo recebe o registro
+// que deve ocupa-la e o temporario fecha o ciclo. Cada registro eh movido
+// uma vez (mais um movimento por ciclo), e um bit por posicao marca as ja
+// colocadas, ja que perm nao pode ser alterada.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Elementos ate este tamanho usam um temporario na pilha
+	const size_t TMP_PILHA = 256;
+
+	/// Distancia, em indices, do prefetch de gather e scatter
+	const size_t ADIANTE = 16;
+
+	/// Ordena os indices de [idx, idx+count) pelos registros de sz bytes a partir de first
+	template < typename I >
+	void ordena_indices( const void *first, size_t count, size_t sz, graal::Compare cmp, I *idx )
+	{
+		for(size_t i = 0; i < count; ++i)
+			idx[i] = (I) i;
+		if(count < 2)
+			return;
+
+		const byte *base = (const byte*) first;
+		auto menor = [base, sz, cmp]( const byte *a, const byte *b )
+		{
+			I x, y;
+			std::memcpy(&x, a, sizeof(I));
+			std::memcpy(&y, b, sizeof(I));
+			return cmp(base + (size_t) x*sz, base + (size_t) y*sz);
+		};
+
+		byte tmp[sizeof(I)];
+		byte *it = (byte*) idx;
+		graal::sort::pdqsort( it, it + count*sizeof(I), graal::kernels::Fixo< sizeof(I) >(), menor, tmp );
+	}
+
+	/// Coloca em cada posicao i o registro que estava em perm[i], seguindo os ciclos com o nucleo k
+	template < typename I >
+	struct faz_permutacao
+	{
+		byte *first;
+		size_t count;
+		const I *perm;
+		std::uint64_t *colocado;
+		byte *tmp;
+
+		template < typename K >
+		void operator()( K k ) const
+		{
+			const size_t sz = k.size();
+			for(size_t i = 0; i < count; ++i)
+			{
+				if((colocado[i >> 6] >> (i & 63)) & 1)
+					continue;
+
+				// Ciclo de tamanho 1: o registro ja esta no lugar
+				if((size_t) perm[i] == i)
+					continue;
+
+				k.move(tmp, first + i*sz);
+				size_t j = i;
+				for(;;)
+				{
+					colocado[j >> 6] |= (std::uint64_t) 1 << (j & 63);
+					size_t origem = perm[j];
+					if(origem == i)
+						break;
+					k.move(first + j*sz, first + origem*sz);
+					j = origem;
+				}
+				k.move(first + j*sz, tmp);
+			}
+		}
+	};
+
+	template < typename I >
+	void permuta( void *first, size_t count, size_t sz, const I *perm, graal::Allocator &alloc )
+	{
+		if(count < 2)
+			return;
+
+		graal::Buffer marcas( alloc, ((count+63) / 64) * 8 );
+		std::memset(marcas.data(), 0, marcas.size());
+
+		byte pilha[TMP_PILHA];
+		graal::Buffer heap;
+		byte *tmp = pilha;
+		if(sz > TMP_PILHA)
+		{
+			heap = graal::Buffer( alloc, sz );
+			tmp = heap.as< byte >();
+		}
+
+		graal::kernels::despacha( sz, faz_permutacao< I >{ (byte*) first, count, perm,
+				marcas.as< std::uint64_t >(), tmp } );
+	}
+
+	/// dst[i] = src[idx[i]], com prefetch dos registros lidos adiante
+	template < typename I >
+	struct faz_gather
+	{
+		const byte *src;
+		size_t count;
+		const I *idx;
+		byte *dst;
+
+		template < typename K >
+		void operator()( K k ) const
+		{
+			const size_t sz = k.size();
+			for(size_t i = 0; i < count; ++i)
+			{
+				if(i + ADIANTE < count)
+					__builtin_prefetch(src + (size_t) idx[i+ADIANTE]*sz);
+				k.move(dst + i*sz, src + (size_t) idx[i]*sz);
+			}
+		}
+	};
+
+	/// dst[idx[i]] = src[i], com prefetch dos destinos escritos adiante
+	template < typename I >
+	struct faz_scatter
+	{
+		const byte *src;
+		size_t count;
+		const I *idx;
+		byte *dst;
+
+		template < typename K >
+		void operator()( K k ) const
+		{
+			const size_t sz = k.size();
+			for(size_t i = 0; i < count; ++i)
+			{
+				if(i + ADIANTE < count)
+					__builtin_prefetch(dst + (size_t) idx[i+ADIANTE]*sz, 1);
+				k.move(dst + (size_t) idx[i]*sz, src + i*sz);
+			}
+		}
+	};
+}
+
+/// A funcao escreve em indices a ordem dos count registros a partir de first segundo cmp
+void graal::argsort( const void *first, size_t count, size_t sz, Compare cmp, std::uint32_t *indices )
+{
+	// indices de 32 bits nao enderecam mais que UINT32_MAX registros
+	if(count > UINT32_MAX)
+		throw std::invalid_argument( "graal: count excede UINT32_MAX para indices de 32 bits" );
+	ordena_indices( first, count, sz, cmp, indices );
+}
+
+/// A funcao escreve em indices (de 64 bits) a ordem dos count registros a partir de first segundo cmp
+void graal::argsort( const void *first, size_t count, size_t sz, Compare cmp, std::uint64_t *indices )
+{
+	ordena_indices( first, count, sz, cmp, indices );
+}
+
+/// A funcao reordena os count registros a partir de first, colocando em i o registro que estava em perm[i]
+void graal::apply_permutation( void *first, size_t count, size_t sz, const std::uint32_t *perm,
+		Allocator &alloc )
+{
+	permuta( first, count, sz, perm, alloc );
+}
+
+/// A funcao reordena os registros por uma permutacao com indices de 64 bits
+void graal::apply_permutation( void *first, size_t count, size_t sz, const std::uint64_t *perm,
+		Allocator &alloc )
+{
+	permuta( first, count, sz, perm, alloc );
+}
+
+/// A funcao copia para dst[i] o registro src[indices[i]], para i em [0, count)
+void graal::gather( const void *src, size_t count, size_t sz, const std::uint32_t *indices, void *dst )
+{
+	kernels::despacha( sz, faz_gather< std::uint32_t >{ (const byte*) src, count, indices, (byte*) dst } );
+}
+
+/// A funcao copia para dst[i] o registro src[indices[i]], com indices de 64 bits
+void graal::gather( const void *src, size_t count, size_t sz, const std::uint64_t *indices, void *dst )
+{
+	kernels::despacha( sz, faz_gather< std::uint64_t >{ (const byte*) src, count, indices, (byte*) dst } );
+}
+
+/// A funcao copia o registro src[i] para dst[indices[i]], para i em [0, count)
+void graal::scatter( const void *src, size_t count, size_t sz, const std::uint32_t *indices, void *dst )
+{
+	kernels::despacha( sz, faz_scatter< std::uint32_t >{ (const byte*) src, count, indices, (byte*) dst } );
+}
+
+/// A funcao copia o registro src[i] para dst[indices[i]], com indices de 64 bits
+void graal::scatter( const void *src, size_t count, size_t sz, const std::uint64_t *indices, void *dst )
+{
+	kernels::despacha( sz, faz_scatter< std::uint64_t >{ (const byte*) src, count, indices, (byte*) dst } );
+}
@@ -0,0 +1,148 @@
+#include <cstring>
+#include <cstdint>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "bulk.h"
+#include "campo.h"
+
+// Radix sort LSD, um byte da chave por passada, estavel.
+//
+// Um unico percurso inicial monta os histogramas de todos os digitos. Um
+// digito em que todos os elementos tem o mesmo valor (histograma com uma so
+// barra) nao muda a ordem, entao sua passada eh pulada. As passadas
+// restantes espalham os elementos entre o array e o buffer auxiliar.
+//
+// Chaves descritas por Key sao lidas como inteiros sem sinal com a mesma
+// ordem (veja campo.h), entao os digitos sao sempre bytes sem sinal.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Chave devolvida por uma funcao do usuario, ja em ordem sem sinal
+	template < typename U >
+	struct LeFuncao
+	{
+		U (*key)( const void * );
+
+		static const int BYTES = sizeof(U);
+
+		U operator()( const byte *e ) const { return key(e); }
+	};
+
+	/// Ordena [first, last) com o leitor de chave ler e o nucleo k, usando scratch
+	template < typename Ler >
+	struct faz_radix
+	{
+		byte *first, *last, *scratch;
+		Ler ler;
+
+		template < typename K >
+		void operator()( K k ) const
+		{
+			const int D = Ler::BYTES;
+			const size_t sz = k.size();
+			const size_t n = (last-first) / sz;
+
+			// Histogramas de todos os digitos em uma passada
+			size_t hist[D][256];
+			std::memset(hist, 0, sizeof(hist));
+			for(const byte *it = first; it!=last; it += sz)
+			{
+				auto chave = ler(it);
+				for(int d = 0; d < D; ++d)
+					++hist[d][(chave >> (8*d)) & 0xff];
+			}
+
+			byte *src = first;
+			byte *dst = scratch;
+			auto primeira = ler(first);
+
+			for(int d = 0; d < D; ++d)
+			{
+				// Digito constante: a passada nao mudaria nada
+				if(hist[d][(primeira >> (8*d)) & 0xff] == n)
+					continue;
+
+				// Posicao inicial de cada valor do digito
+				size_t pos[256];
+				size_t soma = 0;
+				for(int v = 0; v < 256; ++v)
+				{
+					pos[v] = soma;
+					soma += hist[d][v];
+				}
+
+				const byte *fim = src + n*sz;
+				for(const byte *it = src; it!=fim; it += sz)
+				{
+					size_t v = (ler(it) >> (8*d)) & 0xff;
+					k.move(dst + pos[v]*sz, it);
+					++pos[v];
+				}
+
+				byte *t = src;
+				src = dst;
+				dst = t;
+			}
+
+			// Numero impar de passadas: o resultado esta no buffer auxiliar
+			if(src!=first)
+				graal::bulk::move(first, src, n*sz, graal::CopyMode::Auto);
+		}
+	};
+
+	/// Aloca scratch se necessario e executa o radix sort com o leitor ler
+	template < typename Ler >
+	void radix( void *first, size_t count, size_t sz, Ler ler, void *scratch, graal::Allocator &alloc )
+	{
+		if(count < 2)
+			return;
+
+		graal::Buffer proprio;
+		if(scratch == nullptr)
+		{
+			proprio = graal::Buffer( alloc, count*sz );
+			scratch = proprio.data();
+		}
+
+		byte *it = (byte*) first;
+		graal::kernels::despacha( sz, faz_radix< Ler >{ it, it + count*sz, (byte*) scratch, ler } );
+	}
+
+	/// Executa o radix sort com o leitor do campo escolhido por campos::despacha
+	struct faz_radix_campo
+	{
+		void *first;
+		size_t count, sz;
+		void *scratch;
+		graal::Allocator *alloc;
+
+		template < typename U >
+		void operator()( graal::campos::LeCampo< U > ler ) const
+		{
+			radix(first, count, sz, ler, scratch, *alloc);
+		}
+	};
+}
+
+/// A funcao ordena de forma estavel os count elementos pela chave descrita em key
+void graal::radix_sort( void *first, size_t count, size_t sz, Key key, void *scratch,
+		Allocator &alloc )
+{
+	campos::despacha( key, faz_radix_campo{ first, count, sz, scratch, &alloc } );
+}
+
+/// A funcao ordena de forma estavel os count elementos pela chave de 32 bits devolvida por key
+void graal::radix_sort( void *first, size_t count, size_t sz,
+		std::uint32_t (*key)( const void * ), void *scratch, Allocator &alloc )
+{
+	radix(first, count, sz, LeFuncao< std::uint32_t >{ key }, scratch, alloc);
+}
+
+/// A funcao ordena de forma estavel os count elementos pela chave de 64 bits devolvida por key
+void graal::radix_sort( void *first, size_t count, size_t sz,
+		std::uint64_t (*key)( const void * ), void *scratch, Allocator &alloc )
+{
+	radix(first, count, sz, LeFuncao< std::uint64_t >{ key }, scratch, alloc);
+}
@@ -0,0 +1,228 @@
+#include <cstring>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "simd.h"
+
+// reverse e reverse_copy.
+//
+// Nenhuma das duas aloca memoria. Para elementos de 1, 2, 4 e 8 bytes os
+// dados sao lidos em vetores das duas extremidades, cada vetor tem a ordem
+// dos seus elementos invertida com shuffles (pshufd/pshuflw/pshufhw no SSE2,
+// pshufb/vpermq no AVX2) e eh gravado na extremidade oposta. Cada byte eh
+// lido e escrito uma unica vez; os elementos que sobram no meio sao trocados
+// pelos nucleos de kernels.h.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Inverte [first, last) trocando as extremidades com o nucleo k
+	struct faz_reverse
+	{
+		byte *first, *last;
+
+		template < typename K >
+		void operator()( K k ) const
+		{
+			size_t sz = k.size();
+			byte *it = first;
+			byte *at = last-sz;
+
+			while(it<at)
+			{
+				k.troca(it, at);
+				it += sz;
+				at -= sz;
+			}
+		}
+	};
+
+	/// Copia [first, last) para d_first do ultimo para o primeiro elemento com o nucleo k
+	struct faz_reverse_copy
+	{
+		const byte *first, *last;
+		byte *d_first;
+
+		template < typename K >
+		byte *operator()( K k ) const
+		{
+			size_t sz = k.size();
+			byte *d_it = d_first;
+
+			for(const byte *it = last; it!=first; d_it += sz)
+			{
+				it -= sz;
+				k.move(d_it, it);
+			}
+			return d_it;
+		}
+	};
+
+#ifdef GRAAL_X86
+	/// Inverte a ordem dos elementos de SZ bytes dentro de um vetor de 16 bytes
+	template < size_t SZ >
+	inline __m128i inverte_sse2( __m128i x )
+	{
+		switch(SZ)
+		{
+			case 8: return _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+			case 4: return _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 1, 2, 3));
+		}
+
+		// Palavras de 16 bits: inverte cada metade e depois troca as metades
+		x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+		x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+		x = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+
+		// Bytes: falta trocar os dois bytes de cada palavra
+		if(SZ==1)
+			x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+		return x;
+	}
+
+	/// Inverte a ordem dos elementos de SZ bytes dentro de um vetor de 32 bytes
+	template < size_t SZ >
+	GRAAL_AVX2 inline __m256i inverte_avx2( __m256i x )
+	{
+		switch(SZ)
+		{
+			case 8: return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(0, 1, 2, 3));
+			case 4: return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+		}
+
+		// pshufb inverte dentro de cada metade de 128 bits; vpermq troca as metades
+		const __m256i m = SZ==1
+			? _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+					15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+			: _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+					14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+		x = _mm256_shuffle_epi8(x, m);
+		return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 3, 2));
+	}
+
+	/// Troca vetores das duas extremidades enquanto couberem dois; a e b ficam no que sobrou
+	template < size_t SZ >
+	void reverse_sse2( byte *&a, byte *&b )
+	{
+		while(b-a >= 32)
+		{
+			__m128i x = _mm_loadu_si128((const __m128i*) a);
+			__m128i y = _mm_loadu_si128((const __m128i*) (b-16));
+			_mm_storeu_si128((__m128i*) a, inverte_sse2< SZ >(y));
+			_mm_storeu_si128((__m128i*) (b-16), inverte_sse2< SZ >(x));
+			a += 16;
+			b -= 16;
+		}
+	}
+
+	template < size_t SZ >
+	GRAAL_AVX2 void reverse_avx2( byte *&a, byte *&b )
+	{
+		while(b-a >= 64)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i*) a);
+			__m256i y = _mm256_loadu_si256((const __m256i*) (b-32));
+			_mm256_storeu_si256((__m256i*) a, inverte_avx2< SZ >(y));
+			_mm256_storeu_si256((__m256i*) (b-32), inverte_avx2< SZ >(x));
+			a += 32;
+			b -= 32;
+		}
+	}
+
+	/// Le a origem do fim para o inicio, um vetor por vez; it e d ficam no que sobrou
+	template < size_t SZ >
+	void reverse_copy_sse2( const byte *first, const byte *&it, byte *&d )
+	{
+		while(it-first >= 16)
+		{
+			it -= 16;
+			__m128i x = _mm_loadu_si128((const __m128i*) it);
+			_mm_storeu_si128((__m128i*) d, inverte_sse2< SZ >(x));
+			d += 16;
+		}
+	}
+
+	template < size_t SZ >
+	GRAAL_AVX2 void reverse_copy_avx2( const byte *first, const byte *&it, byte *&d )
+	{
+		while(it-first >= 32)
+		{
+			it -= 32;
+			__m256i x = _mm256_loadu_si256((const __m256i*) it);
+			_mm256_storeu_si256((__m256i*) d, inverte_avx2< SZ >(x));
+			d += 32;
+		}
+	}
+#endif
+
+	/// reverse para elementos de SZ bytes: vetores nas extremidades, nucleo escalar no meio
+	template < size_t SZ >
+	void reverse_fixo( byte *first, byte *last )
+	{
+#ifdef GRAAL_X86
+		if(graal::simd::tem_avx2())
+			reverse_avx2< SZ >(first, last);
+		reverse_sse2< SZ >(first, last);
+#endif
+		if(first!=last)
+			faz_reverse{ first, last }( graal::kernels::Fixo< SZ >() );
+	}
+
+	/// reverse_copy para elementos de SZ bytes
+	template < size_t SZ >
+	byte *reverse_copy_fixo( const byte *first, const byte *last, byte *d )
+	{
+#ifdef GRAAL_X86
+		if(graal::simd::tem_avx2())
+			reverse_copy_avx2< SZ >(first, last, d);
+		reverse_copy_sse2< SZ >(first, last, d);
+#endif
+		return faz_reverse_copy{ first, last, d }( graal::kernels::Fixo< SZ >() );
+	}
+}
+
+/// A funcao inverte a ordem dos elementos do vetor no intervalo [first, last)
+void *graal::reverse( void *first, void *last, size_t sz )
+{
+	byte *it = (byte*) first;
+	byte *at = (byte*) last;
+
+	switch(sz)
+	{
+		case 1: reverse_fixo< 1 >(it, at); return last;
+		case 2: reverse_fixo< 2 >(it, at); return last;
+		case 4: reverse_fixo< 4 >(it, at); return last;
+		case 8: reverse_fixo< 8 >(it, at); return last;
+	}
+
+	if(it!=at)
+		kernels::despacha( sz, faz_reverse{ it, at } );
+
+	return last;
+}
+
+/// A funcao inverte a ordem dos elementos de [first, last) trocando-os com ops
+void *graal::reverse( void *first, void *last, size_t sz, const TypeOps &ops )
+{
+	if(first!=last)
+		faz_reverse{ (byte*) first, (byte*) last }( kernels::Operacoes{ &ops, sz } );
+	return last;
+}
+
+/// A funcao escreve em d_first os elementos de [first, last) em ordem inversa, em uma unica passada
+void *graal::reverse_copy( const void *first, const void *last, void *d_first, size_t sz )
+{
+	const byte *it = (const byte*) first;
+	const byte *at = (const byte*) last;
+	byte *d = (byte*) d_first;
+
+	switch(sz)
+	{
+		case 1: return reverse_copy_fixo< 1 >(it, at, d);
+		case 2: return reverse_copy_fixo< 2 >(it, at, d);
+		case 4: return reverse_copy_fixo< 4 >(it, at, d);
+		case 8: return reverse_copy_fixo< 8 >(it, at, d);
+	}
+
+	return kernels::despacha( sz, faz_reverse_copy{ it, at, d } );
+}
@@ -0,0 +1,176 @@
+#include <cstring>
+#include <cstdint>
+#include "../include/graal.h"
+
+// search e search_n.
+//
+// Com Equal nao ha o que saber sobre os elementos alem de eq, entao search
+// tenta cada posicao (O(n*m) no pior caso). No modo bit a bit usa Horspool:
+// a janela eh comparada pelo ultimo elemento e, se nao casar, avanca conforme
+// uma tabela de saltos indexada por uma chave de 8 bits tirada dos bytes do
+// elemento do texto sob o ultimo da janela. Chaves iguais de elementos
+// diferentes so encurtam o salto, nunca o deixam longo demais.
+//
+// search_n verifica cada janela de tras para frente: um elemento diferente
+// na posicao k descarta todas as janelas que o contem, e o proximo teste eh
+// count elementos adiante. Cada elemento eh testado no maximo uma vez.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Chave de 8 bits de um elemento: o proprio byte, ou os primeiros 8 bytes espalhados por uma multiplicacao
+	template < size_t SZ >
+	inline unsigned chave( const byte *e, size_t sz )
+	{
+		if(SZ == 1)
+			return e[0];
+
+		std::uint64_t w = 0;
+		std::memcpy(&w, e, (SZ ? SZ : sz) < 8 ? (SZ ? SZ : sz) : 8);
+		return (unsigned) ((w * 0x9e3779b97f4a7c15ull) >> 56);
+	}
+
+	/// Horspool com m >= 2 elementos no padrao; SZ = 0 quando sz nao eh 1, 2, 4 ou 8
+	template < size_t SZ >
+	const byte *horspool( const byte *first, const byte *last, const byte *s_first, size_t m, size_t sz )
+	{
+		const size_t s = SZ ? SZ : sz;
+		const size_t n = (last-first) / s;
+		if(m > n)
+			return last;
+
+		size_t salto[256];
+		for(size_t c = 0; c < 256; ++c)
+			salto[c] = m;
+		for(size_t j = 0; j+1 < m; ++j)
+			salto[chave< SZ >(s_first + j*s, s)] = m-1-j;
+
+		const byte *ultimo = s_first + (m-1)*s;
+		for(size_t i = 0; i+m <= n; )
+		{
+			const byte *w = first + i*s;
+			const byte *e = w + (m-1)*s;
+			if(std::memcmp(e, ultimo, s)==0 && std::memcmp(w, s_first, (m-1)*s)==0)
+				return w;
+			i += salto[chave< SZ >(e, s)];
+		}
+		return last;
+	}
+
+	/// Compara os bytes de um elemento com value; SZ = 0 quando sz so eh conhecido em tempo de execucao
+	template < size_t SZ >
+	struct IgualBits
+	{
+		const void *value;
+		size_t sz;
+
+		bool operator()( const byte *e ) const
+		{
+			return std::memcmp(e, value, SZ ? SZ : sz)==0;
+		}
+	};
+
+	/// Primeira sequencia de count elementos seguidos com igual(e) verdadeiro, ou last
+	template < typename Igual >
+	const byte *procura_n( const byte *first, const byte *last, size_t sz, size_t count, Igual igual )
+	{
+		if(count == 0)
+			return first;
+
+		size_t resto = (last-first) / sz;
+		size_t falta = count;
+		const byte *fim = first;    // um apos o fim da janela atual
+
+		while(falta <= resto)
+		{
+			fim += falta*sz;
+			resto -= falta;
+
+			// Os elementos antes de fim-falta ja foram testados e sao iguais
+			const byte *it = fim;
+			for(;;)
+			{
+				it -= sz;
+				if(!igual(it))
+					break;
+				if(--falta == 0)
+					return fim - count*sz;
+			}
+			falta = count - (fim-it-sz) / sz;
+		}
+		return last;
+	}
+}
+
+/// A funcao retorna o inicio da primeira ocorrencia de [s_first; s_last) em [first; last) segundo eq
+const void *graal::search( const void *first, const void *last, const void *s_first, const void *s_last,
+		size_t sz, Equal eq )
+{
+	const byte *it = (const byte*) first;
+	const byte *at = (const byte*) last;
+	const byte *p = (const byte*) s_first;
+	size_t m = ((const byte*) s_last - p) / sz;
+	size_t n = (at-it) / sz;
+
+	if(m == 0)
+		return first;
+
+	for(; n >= m; it += sz, --n)
+	{
+		size_t j = 0;
+		while(j < m && eq(it + j*sz, p + j*sz))
+			++j;
+		if(j == m)
+			return it;
+	}
+	return last;
+}
+
+/// A funcao retorna o inicio da primeira ocorrencia dos bytes de [s_first; s_last) em [first; last), alinhada aos elementos
+const void *graal::search( const void *first, const void *last, const void *s_first, const void *s_last,
+		size_t sz, Bitwise )
+{
+	const byte *it = (const byte*) first;
+	const byte *at = (const byte*) last;
+	const byte *p = (const byte*) s_first;
+	size_t m = ((const byte*) s_last - p) / sz;
+
+	if(m == 0)
+		return first;
+	if(m == 1)
+		return find(first, last, sz, s_first, bitwise);
+
+	switch(sz)
+	{
+		case 1: return horspool< 1 >(it, at, p, m, sz);
+		case 2: return horspool< 2 >(it, at, p, m, sz);
+		case 4: return horspool< 4 >(it, at, p, m, sz);
+		case 8: return horspool< 8 >(it, at, p, m, sz);
+	}
+	return horspool< 0 >(it, at, p, m, sz);
+}
+
+/// A funcao retorna o inicio da primeira sequencia de count elementos iguais a value segundo eq
+const void *graal::search_n( const void *first, const void *last, size_t count, const void *value,
+		size_t sz, Equal eq )
+{
+	return procura_n( (const byte*) first, (const byte*) last, sz, count,
+			[value, eq]( const byte *e ) { return eq(e, value); } );
+}
+
+/// A funcao retorna o inicio da primeira sequencia de count elementos com os mesmos bytes de value
+const void *graal::search_n( const void *first, const void *last, size_t count, const void *value,
+		size_t sz, Bitwise )
+{
+	const byte *it = (const byte*) first;
+	const byte *at = (const byte*) last;
+	switch(sz)
+	{
+		case 1: return procura_n(it, at, sz, count, IgualBits< 1 >{ value, sz });
+		case 2: return procura_n(it, at, sz, count, IgualBits< 2 >{ value, sz });
+		case 4: return procura_n(it, at, sz, count, IgualBits< 4 >{ value, sz });
+		case 8: return procura_n(it, at, sz, count, IgualBits< 8 >{ value, sz });
+	}
+	return procura_n(it, at, sz, count, IgualBits< 0 >{ value, sz });
+}
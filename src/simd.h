@@ -0,0 +1,36 @@
+#ifndef GRAAL_SIMD
+#define GRAAL_SIMD
+
+// Deteccao das extensoes vetoriais usadas pelos nucleos SIMD da biblioteca.
+//
+// SSE2 faz parte de toda CPU x86-64, entao eh usado sem verificacao. AVX2 eh
+// compilado apenas nas funcoes marcadas com GRAAL_AVX2 e escolhido em tempo de
+// execucao por tem_avx2(). Em outras arquiteturas GRAAL_X86 nao eh definido e
+// os algoritmos usam apenas o laco escalar.
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GRAAL_X86 1
+#include <immintrin.h>
+#define GRAAL_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace graal
+{
+	namespace simd
+	{
+		/// Retorna true se a CPU em execucao suporta AVX2 (consultado uma unica vez)
+		inline bool tem_avx2()
+		{
+#ifdef GRAAL_X86
+			static const bool tem = []{
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2") != 0;
+			}();
+			return tem;
+#else
+			return false;
+#endif
+		}
+	}
+}
+#endif
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <new>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "sort.h"
+#include "timsort.h"
+#include "campo.h"
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Elementos ate este tamanho usam um temporario na pilha
+	const size_t TMP_PILHA = 256;
+
+	/// Media minima de elementos por run para que qsort use o timsort
+	const size_t RUN_MEDIA = 256;
+
+	/// Quantidade de runs sempre aceita, mesmo em intervalos pequenos
+	const size_t MIN_RUNS = 8;
+
+	/* Conta as runs de [first, last), sequencias crescentes ou estritamente
+	 * decrescentes, invertendo as decrescentes. Retorna 0 se passarem de
+	 * max(MIN_RUNS, n/RUN_MEDIA): desiste na primeira run alem do limite,
+	 * entao numa entrada sem runs longas custa cerca de 2*n/RUN_MEDIA
+	 * comparacoes.
+	 */
+	template < typename K, typename Cmp >
+	size_t conta_runs( byte *first, byte *last, K k, Cmp cmp )
+	{
+		const size_t s = k.size();
+		const size_t limite = std::max(MIN_RUNS, (size_t) (last-first) / s / RUN_MEDIA);
+
+		size_t runs = 0;
+		for(byte *it = first; it!=last; )
+		{
+			if(++runs > limite)
+				return 0;
+
+			byte *prox = it+s;
+			if(prox!=last && cmp(prox, it))
+			{
+				while(prox+s!=last && cmp(prox+s, prox))
+					prox += s;
+				prox += s;
+				graal::reverse(it, prox, s);
+			}
+			else
+			{
+				while(prox!=last && !cmp(prox, prox-s))
+					prox += s;
+			}
+			it = prox;
+		}
+		return runs;
+	}
+
+	/* Ordena [first, last) usando o nucleo k. Entradas formadas por runs
+	 * longas (organ pipe, quase ordenadas), que o pdqsort so pega quando
+	 * ha pouquissimos elementos fora do lugar, vao para o timsort, que as
+	 * funde em tempo proximo de linear; as demais vao para o pdqsort.
+	 */
+	template < typename Cmp >
+	struct faz_qsort
+	{
+		byte *first, *last;
+		Cmp cmp;
+		byte *tmp;
+
+		template < typename K >
+		void operator()( K k ) const
+		{
+			const size_t n = (last-first) / k.size();
+			size_t runs = n >= RUN_MEDIA ? conta_runs( first, last, k, cmp ) : 0;
+			if(runs == 1)
+				return;
+			if(runs > 1)
+			{
+				// O buffer das fusoes tem ate n/2 elementos. Se nao puder ser
+				// alocado, o intervalo (ainda uma permutacao da entrada) vai
+				// para o pdqsort
+				try
+				{
+					graal::sort::Timsort< K, Cmp > ts{ k, cmp, tmp, n/2, &graal::default_allocator(),
+							graal::Buffer(), 0, graal::sort::MIN_GALLOP, {} };
+					ts.ordena( first, n );
+					return;
+				}
+				catch(const std::bad_alloc &)
+				{
+				}
+			}
+			graal::sort::pdqsort( first, last, k, cmp, tmp );
+		}
+	};
+
+	/// Ordena os count elementos a partir de first com cmp, escolhendo o temporario e o nucleo
+	template < typename Cmp >
+	void ordena( void *first, size_t count, size_t sz, Cmp cmp )
+	{
+		if(count < 2)
+			return;
+
+		byte *it = (byte*) first;
+		byte *at = it + count*sz;
+
+		// Espaco para um elemento, usado pelo insertion sort
+		byte pilha[TMP_PILHA];
+		graal::Buffer heap;
+		byte *tmp = pilha;
+		if(sz > TMP_PILHA)
+		{
+			heap = graal::Buffer( graal::default_allocator(), sz );
+			tmp = heap.as< byte >();
+		}
+
+		graal::kernels::despacha( sz, faz_qsort< Cmp >{ it, at, cmp, tmp } );
+	}
+
+	/// Ordena comparando as chaves lidas por ler como inteiros sem sinal
+	struct faz_qsort_campo
+	{
+		void *first;
+		size_t count, sz;
+
+		template < typename U >
+		void operator()( graal::campos::LeCampo< U > ler ) const
+		{
+			ordena( first, count, sz, [ler]( const byte *a, const byte *b ) { return ler(a) < ler(b); } );
+		}
+	};
+}
+
+/// A funcao ordena os count elementos a partir de first de acordo com cmp
+void graal::qsort( void *first, size_t count, size_t sz, Compare cmp )
+{
+	ordena( first, count, sz, cmp );
+}
+
+/// A funcao ordena os count elementos a partir de first pela chave descrita em key
+void graal::qsort( void *first, size_t count, size_t sz, Key key )
+{
+	campos::despacha( key, faz_qsort_campo{ first, count, sz } );
+}
+
+/// A funcao ordena os count elementos a partir de first de acordo com cmp, movendo-os com ops
+void graal::qsort( void *first, size_t count, size_t sz, Compare cmp, const TypeOps &ops )
+{
+	if(count < 2)
+		return;
+
+	byte *it = (byte*) first;
+
+	// O temporario precisa ser um objeto vivo: eh construido movendo o
+	// primeiro elemento, que recebe seu valor de volta
+	Buffer espaco( default_allocator(), sz );
+	byte *tmp = espaco.as< byte >();
+	ops.move_construct(tmp, it);
+	ops.move_assign(it, tmp);
+
+	sort::pdqsort( it, it + count*sz, kernels::Operacoes{ &ops, sz }, cmp, tmp );
+	ops.destroy(tmp);
+}
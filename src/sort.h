@@ -0,0 +1,430 @@
+#ifndef GRAAL_SORT
+#define GRAAL_SORT
+
+#include <cstddef>
+#include "../include/graal.h"
+#include "kernels.h"
+
+// Pattern-defeating quicksort (pdqsort) sobre elementos de sz bytes.
+//
+// - pivo pela mediana de 3, ou pela pseudomediana de 9 (ninther) em
+//   intervalos grandes;
+// - insertion sort em particoes pequenas;
+// - particoes muito desbalanceadas embaralham alguns elementos e, depois de
+//   log2(n) delas, o intervalo eh ordenado com heapsort, garantindo O(n log n);
+// - intervalos ja particionados tentam um insertion sort parcial, o que deixa
+//   entradas ordenadas ou invertidas em tempo linear;
+// - quando o pivo eh igual ao elemento anterior a particao, os iguais vao para
+//   a esquerda de uma vez (partition_left), entao muitos repetidos sao rapidos;
+// - a particao principal eh feita em blocos (BlockQuicksort), sem desvios que
+//   dependam do resultado da comparacao.
+//
+// K eh um nucleo de kernels.h (troca/move de elementos) e Cmp recebe dois
+// ponteiros para elementos. O pivo fica em *first durante a particao, entao
+// so eh preciso um elemento temporario (tmp), usado pelo insertion sort e
+// pelas permutacoes ciclicas da particao em blocos.
+
+namespace graal
+{
+	namespace sort
+	{
+		using byte = detail::byte;
+
+		const ptrdiff_t LIMITE_INSERTION = 24;
+		const ptrdiff_t LIMITE_NINTHER = 128;
+		const size_t LIMITE_PARCIAL = 8;
+		const size_t BLOCO = 64;
+
+		template < typename K, typename Cmp >
+		struct Pdq
+		{
+			K k;
+			Cmp cmp;
+			byte *tmp;
+
+			size_t sz() const { return k.size(); }
+
+			/// Quantidade de elementos em [a, b)
+			ptrdiff_t n( const byte *a, const byte *b ) const { return (b-a) / (ptrdiff_t) sz(); }
+
+			byte *em( byte *p, ptrdiff_t i ) const { return p + i * (ptrdiff_t) sz(); }
+
+			void troca( byte *a, byte *b ) const { k.troca(a, b); }
+
+			/// Ordena dois elementos
+			void ordena2( byte *a, byte *b ) const
+			{
+				if(cmp(b, a))
+					troca(a, b);
+			}
+
+			/// Ordena tres elementos
+			void ordena3( byte *a, byte *b, byte *c ) const
+			{
+				ordena2(a, b);
+				ordena2(b, c);
+				ordena2(a, b);
+			}
+
+			/// Insertion sort; se guardado for falso, o elemento antes de first eh menor ou igual a todos
+			void insertion( byte *first, byte *last, bool guardado ) const
+			{
+				const size_t s = sz();
+				if(first==last)
+					return;
+
+				for(byte *cur = first+s; cur!=last; cur += s)
+				{
+					byte *sift = cur;
+					byte *sift_1 = cur-s;
+
+					if(cmp(sift, sift_1))
+					{
+						k.move(tmp, sift);
+						do
+						{
+							k.move(sift, sift_1);
+							sift -= s;
+						}
+						while((!guardado || sift!=first) && cmp(tmp, sift_1 -= s));
+						k.move(sift, tmp);
+					}
+				}
+			}
+
+			/// Insertion sort que desiste apos LIMITE_PARCIAL movimentos; retorna true se ordenou
+			bool insertion_parcial( byte *first, byte *last ) const
+			{
+				const size_t s = sz();
+				if(first==last)
+					return true;
+
+				size_t limite = 0;
+				for(byte *cur = first+s; cur!=last; cur += s)
+				{
+					if(limite > LIMITE_PARCIAL)
+						return false;
+
+					byte *sift = cur;
+					byte *sift_1 = cur-s;
+
+					if(cmp(sift, sift_1))
+					{
+						k.move(tmp, sift);
+						do
+						{
+							k.move(sift, sift_1);
+							sift -= s;
+						}
+						while(sift!=first && cmp(tmp, sift_1 -= s));
+						k.move(sift, tmp);
+						limite += (cur-sift) / s;
+					}
+				}
+				return true;
+			}
+
+			/// Desce o elemento i do heap [first, first+tam)
+			void desce( byte *first, ptrdiff_t i, ptrdiff_t tam ) const
+			{
+				for(;;)
+				{
+					ptrdiff_t filho = 2*i+1;
+					if(filho >= tam)
+						return;
+					if(filho+1 < tam && cmp(em(first, filho), em(first, filho+1)))
+						++filho;
+					if(!cmp(em(first, i), em(first, filho)))
+						return;
+					troca(em(first, i), em(first, filho));
+					i = filho;
+				}
+			}
+
+			void heapsort( byte *first, byte *last ) const
+			{
+				ptrdiff_t tam = n(first, last);
+				for(ptrdiff_t i = tam/2-1; i >= 0; --i)
+					desce(first, i, tam);
+				for(ptrdiff_t fim = tam-1; fim > 0; --fim)
+				{
+					troca(first, em(first, fim));
+					desce(first, 0, fim);
+				}
+			}
+
+			/* Troca num pares: o i-esimo elemento marcado a esquerda (a partir de
+			 * base_l) com o i-esimo marcado a direita (contando para tras a partir de
+			 * base_r). Com quantidades diferentes nos dois lados, a troca vira uma
+			 * permutacao ciclica, que move cada elemento uma vez em vez de duas.
+			 */
+			void troca_blocos( byte *base_l, byte *base_r, const unsigned char *off_l,
+					const unsigned char *off_r, size_t num, bool trocas ) const
+			{
+				const size_t s = sz();
+				if(trocas)
+				{
+					for(size_t i = 0; i < num; ++i)
+						troca(base_l + off_l[i]*s, base_r - off_r[i]*s);
+				}
+				else if(num > 0)
+				{
+					byte *l = base_l + off_l[0]*s;
+					byte *r = base_r - off_r[0]*s;
+					k.move(tmp, l);
+					k.move(l, r);
+					for(size_t i = 1; i < num; ++i)
+					{
+						l = base_l + off_l[i]*s;
+						k.move(r, l);
+						r = base_r - off_r[i]*s;
+						k.move(l, r);
+					}
+					k.move(r, tmp);
+				}
+			}
+
+			/* Particiona [first, last) em torno do pivo *first: menores a esquerda,
+			 * maiores ou iguais a direita. Retorna a posicao final do pivo e indica
+			 * em ja_particionado se nenhuma troca foi necessaria.
+			 * No estilo BlockQuicksort: cada lado eh percorrido em blocos de BLOCO
+			 * elementos, guardando sem desvios as posicoes dos elementos do lado
+			 * errado, e depois os pares sao trocados de uma vez. O resultado de cmp
+			 * nao decide nenhum desvio.
+			 */
+			byte *partition_right( byte *first, byte *last, bool &ja_particionado ) const
+			{
+				const size_t s = sz();
+				byte *pivo = first;
+				byte *a = first;
+				byte *b = last;
+
+				while(cmp(a += s, pivo));
+
+				if(a-s == first)
+					while(a < b && !cmp(b -= s, pivo));
+				else
+					while(!cmp(b -= s, pivo));
+
+				ja_particionado = a >= b;
+
+				if(!ja_particionado)
+				{
+					troca(a, b);
+					a += s;
+
+					unsigned char off_l[BLOCO], off_r[BLOCO];
+					byte *base_l = a, *base_r = b;
+					size_t num_l = 0, num_r = 0, ini_l = 0, ini_r = 0;
+
+					while(a < b)
+					{
+						// Sobrando menos que dois blocos, divide o que falta entre os lados vazios
+						size_t falta = (b-a) / s;
+						size_t div_l = num_l == 0 ? (num_r == 0 ? falta/2 : falta) : 0;
+						size_t div_r = num_r == 0 ? falta - div_l : 0;
+
+						if(num_l == 0)
+						{
+							size_t m = div_l < BLOCO ? div_l : BLOCO;
+							for(size_t i = 0; i < m; ++i)
+							{
+								off_l[num_l] = (unsigned char) i;
+								num_l += !cmp(a, pivo);
+								a += s;
+							}
+						}
+						if(num_r == 0)
+						{
+							size_t m = div_r < BLOCO ? div_r : BLOCO;
+							for(size_t i = 0; i < m; )
+							{
+								off_r[num_r] = (unsigned char) ++i;
+								b -= s;
+								num_r += cmp(b, pivo);
+							}
+						}
+
+						size_t num = num_l < num_r ? num_l : num_r;
+						troca_blocos(base_l, base_r, off_l + ini_l, off_r + ini_r, num, num_l == num_r);
+						num_l -= num;
+						num_r -= num;
+						ini_l += num;
+						ini_r += num;
+						if(num_l == 0)
+						{
+							ini_l = 0;
+							base_l = a;
+						}
+						if(num_r == 0)
+						{
+							ini_r = 0;
+							base_r = b;
+						}
+					}
+
+					// Sobraram marcados de um lado so: vao para a fronteira
+					if(num_l)
+					{
+						while(num_l--)
+							troca(base_l + off_l[ini_l + num_l]*s, b -= s);
+						a = b;
+					}
+					if(num_r)
+					{
+						while(num_r--)
+						{
+							troca(base_r - off_r[ini_r + num_r]*s, a);
+							a += s;
+						}
+					}
+				}
+
+				byte *pos = a-s;
+				if(pos!=first)
+					troca(first, pos);
+				return pos;
+			}
+
+			/// Particiona colocando os iguais ao pivo *first a esquerda; retorna a posicao do pivo
+			byte *partition_left( byte *first, byte *last ) const
+			{
+				const size_t s = sz();
+				byte *pivo = first;
+				byte *a = first;
+				byte *b = last;
+
+				while(cmp(pivo, b -= s));
+
+				if(b+s == last)
+					while(a < b && !cmp(pivo, a += s));
+				else
+					while(!cmp(pivo, a += s));
+
+				while(a < b)
+				{
+					troca(a, b);
+					while(cmp(pivo, b -= s));
+					while(!cmp(pivo, a += s));
+				}
+
+				if(b!=first)
+					troca(first, b);
+				return b;
+			}
+
+			void loop( byte *first, byte *last, int ruins, bool mais_a_esquerda ) const
+			{
+				const size_t s = sz();
+
+				for(;;)
+				{
+					ptrdiff_t tam = n(first, last);
+
+					if(tam < LIMITE_INSERTION)
+					{
+						insertion(first, last, mais_a_esquerda);
+						return;
+					}
+
+					// Escolhe o pivo e o coloca em *first
+					ptrdiff_t meio = tam/2;
+					if(tam > LIMITE_NINTHER)
+					{
+						ordena3(first, em(first, meio), last-s);
+						ordena3(em(first, 1), em(first, meio-1), last-2*s);
+						ordena3(em(first, 2), em(first, meio+1), last-3*s);
+						ordena3(em(first, meio-1), em(first, meio), em(first, meio+1));
+						troca(first, em(first, meio));
+					}
+					else
+						ordena3(em(first, meio), first, last-s);
+
+					// Pivo igual ao elemento anterior: todos os iguais ja estao no lugar certo
+					if(!mais_a_esquerda && !cmp(first-s, first))
+					{
+						first = partition_left(first, last) + s;
+						continue;
+					}
+
+					bool ja_particionado;
+					byte *pos = partition_right(first, last, ja_particionado);
+
+					ptrdiff_t tam_e = n(first, pos);
+					ptrdiff_t tam_d = n(pos+s, last);
+					bool desbalanceado = tam_e < tam/8 || tam_d < tam/8;
+
+					if(desbalanceado)
+					{
+						// Muitas particoes ruins: heapsort garante O(n log n)
+						if(--ruins == 0)
+						{
+							heapsort(first, last);
+							return;
+						}
+
+						// Embaralha alguns elementos para quebrar padroes ruins
+						if(tam_e >= LIMITE_INSERTION)
+						{
+							troca(first, em(first, tam_e/4));
+							troca(pos-s, pos - (tam_e/4)*s);
+							if(tam_e > LIMITE_NINTHER)
+							{
+								troca(em(first, 1), em(first, tam_e/4+1));
+								troca(em(first, 2), em(first, tam_e/4+2));
+								troca(pos-2*s, pos - (tam_e/4+1)*s);
+								troca(pos-3*s, pos - (tam_e/4+2)*s);
+							}
+						}
+						if(tam_d >= LIMITE_INSERTION)
+						{
+							troca(pos+s, em(pos, 1+tam_d/4));
+							troca(last-s, last - (tam_d/4)*s);
+							if(tam_d > LIMITE_NINTHER)
+							{
+								troca(pos+2*s, em(pos, 2+tam_d/4));
+								troca(pos+3*s, em(pos, 3+tam_d/4));
+								troca(last-2*s, last - (1+tam_d/4)*s);
+								troca(last-3*s, last - (2+tam_d/4)*s);
+							}
+						}
+					}
+					else if(ja_particionado
+							&& insertion_parcial(first, pos)
+							&& insertion_parcial(pos+s, last))
+						return;
+
+					// Recursao na esquerda, laco na direita
+					loop(first, pos, ruins, mais_a_esquerda);
+					first = pos+s;
+					mais_a_esquerda = false;
+				}
+			}
+		};
+
+		/// Quantidade de bits de n, ou seja, log2(n)+1: limite de particoes ruins
+		inline int log2( size_t n )
+		{
+			int r = 1;
+			while(n >>= 1)
+				++r;
+			return r;
+		}
+
+		/* first, last: intervalo a ordenar;
+		 * k: nucleo de troca/move para o tamanho dos elementos;
+		 * cmp: cmp(a, b) retorna true se o elemento em a for menor que o em b;
+		 * tmp: espaco para um elemento;
+		 */
+		template < typename K, typename Cmp >
+		void pdqsort( byte *first, byte *last, K k, Cmp cmp, byte *tmp )
+		{
+			if(first==last)
+				return;
+
+			Pdq< K, Cmp > pdq{ k, cmp, tmp };
+			pdq.loop(first, last, log2((last-first) / k.size()), true);
+		}
+	}
+}
+#endif
@@ -0,0 +1,128 @@
+#include <cstdint>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "bulk.h"
+
+// stable_partition: como partition, mas os dois grupos mantem a ordem
+// original.
+//
+// Com buffer para todos os falsos, uma passada resolve: cada elemento eh
+// copiado para o fim do buffer e de la para a saida dos verdadeiros, e so o
+// ponteiro do lado certo avanca. Assim nao ha desvio que dependa de p. No
+// fim os falsos voltam do buffer para depois dos verdadeiros.
+//
+// Sem buffer suficiente, o intervalo eh dividido ao meio, cada metade eh
+// particionada recursivamente e os falsos da esquerda trocam de lugar com os
+// verdadeiros da direita por uma rotacao (tres reverses). Os pedacos que
+// cabem no buffer usam a passada acima; sem buffer nenhum o custo eh
+// O(n log n) movimentos. p eh avaliado uma unica vez por elemento.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	template < typename K >
+	struct Estavel
+	{
+		K k;
+		graal::Predicate p;
+		byte *buf;
+		size_t cap;    // elementos que cabem em buf
+
+		/* Particiona n elementos a partir de first usando o buffer; n <= cap.
+		 * falso: o primeiro elemento ja se sabe falso e p nao eh chamado para ele.
+		 */
+		byte *com_buffer( byte *first, size_t n, bool falso ) const
+		{
+			const size_t s = k.size();
+			byte *out = first;
+			byte *falsos = buf;
+			byte *it = first;
+
+			if(falso)
+			{
+				k.move(falsos, it);
+				falsos += s;
+				it += s;
+			}
+
+			for(byte *fim = first + n*s; it!=fim; it += s)
+			{
+				bool t = p(it);
+				k.move(falsos, it);
+				k.move(out, falsos);
+				out += t ? s : 0;
+				falsos += t ? 0 : s;
+			}
+
+			graal::bulk::move(out, buf, falsos-buf, graal::CopyMode::Cached);
+			return out;
+		}
+
+		/// Troca de lugar os blocos vizinhos [a, b) e [b, c)
+		void rotaciona( byte *a, byte *b, byte *c ) const
+		{
+			if(a==b || b==c)
+				return;
+			graal::reverse(a, b, k.size());
+			graal::reverse(b, c, k.size());
+			graal::reverse(a, c, k.size());
+		}
+
+		/// Particiona n elementos a partir de first; retorna o inicio dos falsos
+		byte *particiona( byte *first, size_t n, bool falso ) const
+		{
+			const size_t s = k.size();
+			if(n <= cap)
+				return com_buffer(first, n, falso);
+			if(n == 1)
+				return !falso && p(first) ? first+s : first;
+
+			byte *meio = first + (n/2)*s;
+			byte *l = particiona(first, n/2, falso);
+			byte *r = particiona(meio, n - n/2, false);
+			rotaciona(l, meio, r);
+			return l + (r-meio);
+		}
+	};
+
+	struct faz_stable_partition
+	{
+		byte *first, *last;
+		graal::Predicate p;
+		size_t max_scratch;
+		graal::Allocator *alloc;
+
+		template < typename K >
+		byte *operator()( K k ) const
+		{
+			const size_t s = k.size();
+
+			// Verdadeiros do comeco ja estao no lugar
+			byte *it = first;
+			while(it!=last && p(it))
+				it += s;
+			if(it==last)
+				return it;
+
+			size_t n = (last-it) / s;
+			size_t cap = max_scratch / s;
+			if(cap > n)
+				cap = n;
+
+			graal::Buffer buffer;
+			if(cap > 0)
+				buffer = graal::Buffer( *alloc, cap*s );
+
+			Estavel< K > e{ k, p, buffer.as< byte >(), cap };
+			return e.particiona(it, n, true);
+		}
+	};
+}
+
+/// A funcao reordena [first, last) com os elementos para os quais p eh verdadeiro antes dos demais, mantendo a ordem relativa em cada grupo
+void *graal::stable_partition( void *first, void *last, size_t sz, Predicate p, size_t max_scratch,
+		Allocator &alloc )
+{
+	return kernels::despacha( sz, faz_stable_partition{ (byte*) first, (byte*) last, p, max_scratch, &alloc } );
+}
@@ -0,0 +1,64 @@
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "timsort.h"
+
+// Ordenacao estavel adaptativa (no estilo do timsort, veja timsort.h).
+//
+// O buffer das fusoes cresce sob demanda ate max_scratch bytes; fusoes que
+// nao cabem sao divididas por busca binaria e rotacao, sem alocar mais.
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Elementos ate este tamanho usam um temporario na pilha
+	const size_t TMP_PILHA = 256;
+
+	/// Ordena de forma estavel com o nucleo k; retorna os bytes de buffer alocados
+	struct faz_stable_sort
+	{
+		byte *first;
+		size_t count;
+		graal::Compare cmp;
+		byte *tmp;
+		size_t limite;
+		graal::Allocator *alloc;
+
+		template < typename K >
+		size_t operator()( K k ) const
+		{
+			graal::sort::Timsort< K > ts{ k, cmp, tmp, limite, alloc, graal::Buffer(), 0, graal::sort::MIN_GALLOP, {} };
+			ts.ordena(first, count);
+			return ts.buffer.size();
+		}
+	};
+}
+
+/// A funcao ordena de forma estavel os count elementos a partir de first de acordo com cmp
+size_t graal::stable_sort( void *first, size_t count, size_t sz, Compare cmp, size_t max_scratch,
+		Allocator &alloc )
+{
+	if(count < 2)
+		return 0;
+
+	// Espaco para um elemento, usado pelo insertion sort
+	byte pilha[TMP_PILHA];
+	Buffer heap;
+	byte *tmp = pilha;
+	if(sz > TMP_PILHA)
+	{
+		heap = Buffer( alloc, sz );
+		tmp = heap.as< byte >();
+	}
+
+	// Uma fusao nunca precisa de mais que metade dos elementos
+	size_t limite = max_scratch / sz;
+	if(limite > count/2)
+		limite = count/2;
+
+	size_t usado = kernels::despacha( sz, faz_stable_sort{ (byte*) first, count, cmp, tmp, limite, &alloc } );
+	return usado + heap.size();
+}
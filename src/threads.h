@@ -0,0 +1,58 @@
+#ifndef GRAAL_THREADS
+#define GRAAL_THREADS
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Execucao de um mesmo trabalho em varias threads, usada pelos algoritmos
+// paralelos. A thread que chama tambem trabalha, como a de indice 0.
+
+namespace graal
+{
+	namespace threads
+	{
+		/// Quantidade de threads a usar: pedidas, ou o numero de nucleos se pedidas for 0
+		inline unsigned quantas( unsigned pedidas )
+		{
+			if(pedidas == 0)
+				pedidas = std::thread::hardware_concurrency();
+			return pedidas ? pedidas : 1;
+		}
+
+		/// Executa f(t) para t em [0, n) em n threads e espera todas terminarem.
+		/// Uma excecao de f eh guardada e relancada na thread que chama,
+		/// depois que todas terminam (a primeira, se houver varias).
+		template < typename F >
+		void executa( unsigned n, F f )
+		{
+			std::vector< std::exception_ptr > erros( n );
+			auto protegida = [&f, &erros]( unsigned t )
+			{
+				try
+				{
+					f(t);
+				}
+				catch(...)
+				{
+					erros[t] = std::current_exception();
+				}
+			};
+
+			std::vector< std::thread > ts;
+			ts.reserve(n);
+			for(unsigned t = 1; t < n; ++t)
+				ts.emplace_back(protegida, t);
+
+			protegida(0u);
+
+			for(auto &t : ts)
+				t.join();
+
+			for(auto &e : erros)
+				if(e)
+					std::rethrow_exception(e);
+		}
+	}
+}
+#endif
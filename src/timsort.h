@@ -0,0 +1,570 @@
+#ifndef GRAAL_TIMSORT
+#define GRAAL_TIMSORT
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "../include/graal.h"
+
+// Ordenacao estavel adaptativa (no estilo do timsort).
+//
+// 1. O intervalo eh percorrido uma vez procurando sequencias ja ordenadas
+//    (runs). Runs estritamente decrescentes sao invertidas; estritamente para
+//    que elementos iguais nao troquem de ordem. Runs curtas sao estendidas ate
+//    min_run elementos com insertion sort binario.
+// 2. As runs vao para uma pilha que mantem seus tamanhos crescendo como
+//    Fibonacci, entao ha no maximo O(log n) runs pendentes e as fusoes sao
+//    balanceadas.
+// 3. Antes de cada fusao, buscas exponenciais (galloping) descartam o comeco
+//    da run esquerda e o fim da direita que ja estao no lugar. A fusao copia a
+//    menor das duas runs para o buffer e, quando uma run vence varias
+//    comparacoes seguidas, passa a avancar por busca exponencial.
+// 4. O buffer cresce sob demanda ate max_scratch bytes. Fusoes que nao cabem
+//    sao divididas por busca binaria e rotacao ate caberem, sem alocar mais.
+//
+// Entradas ja ordenadas, invertidas ou formadas por poucas runs ordenadas
+// terminam em tempo linear.
+//
+// K eh um nucleo de kernels.h que move os bytes dos elementos (o buffer
+// guarda copias) e Cmp recebe dois ponteiros para elementos. Usado por
+// stable_sort e por qsort, em entradas formadas por runs longas.
+
+namespace graal
+{
+	namespace sort
+	{
+		using byte = detail::byte;
+
+		/// Abaixo deste tamanho o intervalo inteiro vira uma run por insertion sort
+		const size_t MIN_MERGE = 32;
+
+		/// Vitorias seguidas de uma run para entrar no modo galloping
+		const size_t MIN_GALLOP = 7;
+
+		/// Tamanho minimo das runs: entre MIN_MERGE/2 e MIN_MERGE, de forma que n/min_run seja potencia de 2 ou pouco menos
+		inline size_t min_run( size_t n )
+		{
+			size_t r = 0;
+			while(n >= MIN_MERGE)
+			{
+				r |= n & 1;
+				n >>= 1;
+			}
+			return n + r;
+		}
+
+		struct Run
+		{
+			byte *base;
+			size_t n;
+		};
+
+		template < typename K, typename Cmp = graal::Compare >
+		struct Timsort
+		{
+			K k;
+			Cmp cmp;
+			byte *tmp;
+			size_t limite;         // maximo de elementos no buffer
+			graal::Allocator *alloc;
+			graal::Buffer buffer;
+			size_t capacidade;     // elementos que cabem no buffer atual
+			size_t min_gallop;
+			std::vector< Run > pilha;
+
+			size_t sz() const { return k.size(); }
+
+			byte *em( byte *p, ptrdiff_t i ) const { return p + i * (ptrdiff_t) sz(); }
+
+			/// Move n elementos de s para d; os intervalos podem se sobrepor
+			void move_n( byte *d, const byte *s, size_t n ) const
+			{
+				std::memmove(d, s, n*sz());
+			}
+
+			/// Garante espaco para n elementos no buffer; n nunca passa de limite
+			byte *reserva( size_t n )
+			{
+				if(n > capacidade)
+				{
+					size_t nova = capacidade*2 > n ? capacidade*2 : n;
+					if(nova > limite)
+						nova = limite;
+					buffer = graal::Buffer();
+					buffer = graal::Buffer( *alloc, nova*sz() );
+					capacidade = nova;
+				}
+				return buffer.as< byte >();
+			}
+
+			/* Insertion sort binario de [lo, hi), sabendo que [lo, inicio) ja esta
+			 * ordenado. Cada elemento vai depois dos iguais a ele, mantendo a ordem.
+			 */
+			void insertion_binario( byte *lo, byte *hi, byte *inicio ) const
+			{
+				const size_t s = sz();
+				for(byte *it = inicio; it!=hi; it += s)
+				{
+					size_t a = 0, b = (it-lo) / s;
+					while(a < b)
+					{
+						size_t m = a + (b-a)/2;
+						if(cmp(it, em(lo, m)))
+							b = m;
+						else
+							a = m+1;
+					}
+
+					byte *pos = em(lo, a);
+					if(pos!=it)
+					{
+						k.move(tmp, it);
+						move_n(pos+s, pos, (it-pos) / s);
+						k.move(pos, tmp);
+					}
+				}
+			}
+
+			/// Tamanho da run que comeca em lo; se for estritamente decrescente ela eh invertida
+			size_t conta_run( byte *lo, byte *hi ) const
+			{
+				const size_t s = sz();
+				byte *it = lo+s;
+				if(it==hi)
+					return 1;
+
+				if(cmp(it, lo))
+				{
+					while(it+s!=hi && cmp(it+s, it))
+						it += s;
+					graal::reverse(lo, it+s, s);
+				}
+				else
+				{
+					while(it+s!=hi && !cmp(it+s, it))
+						it += s;
+				}
+				return (it+s-lo) / s;
+			}
+
+			/* Numero de elementos de a[0, n) menores que *chave, por busca
+			 * exponencial a partir de a[dica] seguida de busca binaria.
+			 */
+			size_t gallop_left( const byte *chave, byte *a, size_t n, size_t dica ) const
+			{
+				ptrdiff_t ultimo = 0, ofs = 1;
+
+				if(cmp(em(a, dica), chave))
+				{
+					// a[dica] < chave: avanca para a direita
+					ptrdiff_t max = n - dica;
+					while(ofs < max && cmp(em(a, dica+ofs), chave))
+					{
+						ultimo = ofs;
+						ofs = 2*ofs + 1;
+					}
+					if(ofs > max)
+						ofs = max;
+					ultimo += dica;
+					ofs += dica;
+				}
+				else
+				{
+					// chave <= a[dica]: recua para a esquerda
+					ptrdiff_t max = dica + 1;
+					while(ofs < max && !cmp(em(a, dica-ofs), chave))
+					{
+						ultimo = ofs;
+						ofs = 2*ofs + 1;
+					}
+					if(ofs > max)
+						ofs = max;
+					ptrdiff_t t = ultimo;
+					ultimo = dica - ofs;
+					ofs = dica - t;
+				}
+
+				// a[ultimo] < chave <= a[ofs]
+				++ultimo;
+				while(ultimo < ofs)
+				{
+					ptrdiff_t m = ultimo + (ofs-ultimo)/2;
+					if(cmp(em(a, m), chave))
+						ultimo = m+1;
+					else
+						ofs = m;
+				}
+				return ofs;
+			}
+
+			/// Numero de elementos de a[0, n) menores ou iguais a *chave
+			size_t gallop_right( const byte *chave, byte *a, size_t n, size_t dica ) const
+			{
+				ptrdiff_t ultimo = 0, ofs = 1;
+
+				if(cmp(chave, em(a, dica)))
+				{
+					// chave < a[dica]: recua para a esquerda
+					ptrdiff_t max = dica + 1;
+					while(ofs < max && cmp(chave, em(a, dica-ofs)))
+					{
+						ultimo = ofs;
+						ofs = 2*ofs + 1;
+					}
+					if(ofs > max)
+						ofs = max;
+					ptrdiff_t t = ultimo;
+					ultimo = dica - ofs;
+					ofs = dica - t;
+				}
+				else
+				{
+					// a[dica] <= chave: avanca para a direita
+					ptrdiff_t max = n - dica;
+					while(ofs < max && !cmp(chave, em(a, dica+ofs)))
+					{
+						ultimo = ofs;
+						ofs = 2*ofs + 1;
+					}
+					if(ofs > max)
+						ofs = max;
+					ultimo += dica;
+					ofs += dica;
+				}
+
+				// a[ultimo] <= chave < a[ofs]
+				++ultimo;
+				while(ultimo < ofs)
+				{
+					ptrdiff_t m = ultimo + (ofs-ultimo)/2;
+					if(cmp(chave, em(a, m)))
+						ofs = m;
+					else
+						ultimo = m+1;
+				}
+				return ofs;
+			}
+
+			/* Funde a (na elementos) com b logo depois, com na <= nb, copiando a
+			 * para o buffer. Exige b[0] < a[0] e a[na-1] > b[nb-1].
+			 */
+			void merge_lo( byte *a, size_t na, byte *b, size_t nb )
+			{
+				const size_t s = sz();
+				byte *buf = reserva(na);
+				move_n(buf, a, na);
+
+				byte *c1 = buf, *c2 = b, *d = a;
+
+				k.move(d, c2);
+				d += s; c2 += s;
+				if(--nb == 0)
+					goto fim;
+				if(na == 1)
+					goto fim;
+
+				for(;;)
+				{
+					size_t v1 = 0, v2 = 0;
+
+					// Um elemento por vez ate uma run vencer min_gallop vezes seguidas
+					do
+					{
+						if(cmp(c2, c1))
+						{
+							k.move(d, c2);
+							d += s; c2 += s;
+							++v2; v1 = 0;
+							if(--nb == 0)
+								goto fim;
+						}
+						else
+						{
+							k.move(d, c1);
+							d += s; c1 += s;
+							++v1; v2 = 0;
+							if(--na == 1)
+								goto fim;
+						}
+					}
+					while((v1 | v2) < min_gallop);
+
+					// Galloping: copia de uma vez os trechos que vencem
+					do
+					{
+						v1 = gallop_right(c2, c1, na, 0);
+						if(v1)
+						{
+							move_n(d, c1, v1);
+							d += v1*s; c1 += v1*s;
+							na -= v1;
+							if(na <= 1)
+								goto fim;
+						}
+						k.move(d, c2);
+						d += s; c2 += s;
+						if(--nb == 0)
+							goto fim;
+
+						v2 = gallop_left(c1, c2, nb, 0);
+						if(v2)
+						{
+							move_n(d, c2, v2);
+							d += v2*s; c2 += v2*s;
+							nb -= v2;
+							if(nb == 0)
+								goto fim;
+						}
+						k.move(d, c1);
+						d += s; c1 += s;
+						if(--na == 1)
+							goto fim;
+
+						if(min_gallop > 1)
+							--min_gallop;
+					}
+					while(v1 >= MIN_GALLOP || v2 >= MIN_GALLOP);
+
+					// Saiu do galloping: fica mais dificil voltar
+					min_gallop += 2;
+				}
+
+			fim:
+				if(na == 1 && nb > 0)
+				{
+					// Sobrou um elemento de a, maior que todos os de b
+					move_n(d, c2, nb);
+					k.move(d + nb*s, c1);
+				}
+				else if(na > 0)
+					move_n(d, c1, na);
+			}
+
+			/* Funde a (na elementos) com b logo depois, com nb <= na, copiando b
+			 * para o buffer e preenchendo do fim para o inicio.
+			 */
+			void merge_hi( byte *a, size_t na, byte *b, size_t nb )
+			{
+				const size_t s = sz();
+				byte *buf = reserva(nb);
+				move_n(buf, b, nb);
+
+				// Cursores no ultimo elemento de cada run e no ultimo destino
+				byte *c1 = em(a, na-1), *c2 = em(buf, nb-1), *d = em(b, nb-1);
+
+				k.move(d, c1);
+				d -= s; c1 -= s;
+				if(--na == 0)
+					goto fim;
+				if(nb == 1)
+					goto fim;
+
+				for(;;)
+				{
+					size_t v1 = 0, v2 = 0;
+
+					do
+					{
+						if(cmp(c2, c1))
+						{
+							k.move(d, c1);
+							d -= s; c1 -= s;
+							++v1; v2 = 0;
+							if(--na == 0)
+								goto fim;
+						}
+						else
+						{
+							k.move(d, c2);
+							d -= s; c2 -= s;
+							++v2; v1 = 0;
+							if(--nb == 1)
+								goto fim;
+						}
+					}
+					while((v1 | v2) < min_gallop);
+
+					do
+					{
+						v1 = na - gallop_right(c2, a, na, na-1);
+						if(v1)
+						{
+							d -= v1*s; c1 -= v1*s;
+							na -= v1;
+							move_n(d+s, c1+s, v1);
+							if(na == 0)
+								goto fim;
+						}
+						k.move(d, c2);
+						d -= s; c2 -= s;
+						if(--nb == 1)
+							goto fim;
+
+						v2 = nb - gallop_left(c1, buf, nb, nb-1);
+						if(v2)
+						{
+							d -= v2*s; c2 -= v2*s;
+							nb -= v2;
+							move_n(d+s, c2+s, v2);
+							if(nb <= 1)
+								goto fim;
+						}
+						k.move(d, c1);
+						d -= s; c1 -= s;
+						if(--na == 0)
+							goto fim;
+
+						if(min_gallop > 1)
+							--min_gallop;
+					}
+					while(v1 >= MIN_GALLOP || v2 >= MIN_GALLOP);
+
+					min_gallop += 2;
+				}
+
+			fim:
+				if(nb == 1 && na > 0)
+				{
+					// Sobrou um elemento de b, menor que todos os de a
+					d -= na*s; c1 -= na*s;
+					move_n(d+s, c1+s, na);
+					k.move(d, c2);
+				}
+				else if(nb > 0)
+					move_n(d - (nb-1)*s, buf, nb);
+			}
+
+			/// Troca de lugar os blocos vizinhos [a, b) e [b, c)
+			void rotaciona( byte *a, byte *b, byte *c ) const
+			{
+				if(a==b || b==c)
+					return;
+				graal::reverse(a, b, sz());
+				graal::reverse(b, c, sz());
+				graal::reverse(a, c, sz());
+			}
+
+			/// Funde as runs vizinhas a e b
+			void funde( byte *a, size_t na, byte *b, size_t nb )
+			{
+				const size_t s = sz();
+
+				// Comeco de a e fim de b que ja estao no lugar
+				size_t k1 = gallop_right(b, a, na, 0);
+				a += k1*s;
+				na -= k1;
+				if(na == 0)
+					return;
+
+				nb = gallop_left(em(a, na-1), b, nb, nb-1);
+				if(nb == 0)
+					return;
+
+				size_t menor = na <= nb ? na : nb;
+				if(menor <= limite)
+				{
+					if(na <= nb)
+						merge_lo(a, na, b, nb);
+					else
+						merge_hi(a, na, b, nb);
+					return;
+				}
+
+				// Nao cabe no buffer: divide a maior run ao meio, acha o corte na
+				// outra e rotaciona, ficando com duas fusoes independentes menores
+				size_t ma, mb;
+				if(na >= nb)
+				{
+					ma = na/2;
+					mb = gallop_left(em(a, ma), b, nb, 0);
+				}
+				else
+				{
+					mb = nb/2;
+					ma = gallop_right(em(b, mb), a, na, 0);
+				}
+
+				rotaciona(em(a, ma), b, em(b, mb));
+				byte *meio = em(a, ma+mb);
+				if(ma && mb)
+					funde(a, ma, em(a, ma), mb);
+				if(na-ma && nb-mb)
+					funde(meio, na-ma, em(meio, na-ma), nb-mb);
+			}
+
+			/// Funde as runs i e i+1 da pilha
+			void funde_em( size_t i )
+			{
+				Run &a = pilha[i];
+				Run &b = pilha[i+1];
+				funde(a.base, a.n, b.base, b.n);
+				a.n += b.n;
+				pilha.erase(pilha.begin() + i+1);
+			}
+
+			/// Restaura os invariantes de tamanho da pilha de runs
+			void colapsa()
+			{
+				while(pilha.size() > 1)
+				{
+					size_t n = pilha.size()-2;
+					if((n > 0 && pilha[n-1].n <= pilha[n].n + pilha[n+1].n)
+							|| (n > 1 && pilha[n-2].n <= pilha[n-1].n + pilha[n].n))
+					{
+						if(pilha[n-1].n < pilha[n+1].n)
+							--n;
+					}
+					else if(pilha[n].n > pilha[n+1].n)
+						break;
+					funde_em(n);
+				}
+			}
+
+			/// Funde tudo o que sobrou na pilha
+			void colapsa_tudo()
+			{
+				while(pilha.size() > 1)
+				{
+					size_t n = pilha.size()-2;
+					if(n > 0 && pilha[n-1].n < pilha[n+1].n)
+						--n;
+					funde_em(n);
+				}
+			}
+
+			void ordena( byte *first, size_t count )
+			{
+				const size_t s = sz();
+				byte *last = em(first, count);
+
+				if(count < MIN_MERGE)
+				{
+					size_t n = conta_run(first, last);
+					insertion_binario(first, last, em(first, n));
+					return;
+				}
+
+				size_t minimo = min_run(count);
+				for(byte *it = first; it!=last; )
+				{
+					size_t n = conta_run(it, last);
+					size_t resto = (last-it) / s;
+
+					// Run curta: estende ate minimo elementos
+					if(n < minimo)
+					{
+						size_t alvo = resto < minimo ? resto : minimo;
+						insertion_binario(it, em(it, alvo), em(it, n));
+						n = alvo;
+					}
+
+					pilha.push_back(Run{ it, n });
+					colapsa();
+					it = em(it, n);
+				}
+				colapsa_tudo();
+			}
+		};
+	}
+}
+#endif
@@ -0,0 +1,755 @@
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include "../include/graal.h"
+#include "kernels.h"
+#include "campo.h"
+
+// unique: remove todas as repeticoes do intervalo (nao so as vizinhas),
+// mantendo a primeira ocorrencia de cada valor na ordem original.
+//
+// Com uma funcao de hash, os elementos ja mantidos ficam numa tabela de
+// enderecamento aberto (sondagem linear, ocupacao maxima de 1/2). Cada
+// entrada guarda parte do hash e a posicao do elemento na saida, entao eq so
+// eh chamada quando os hashes coincidem. Com o alocador padrao a tabela eh
+// um buffer por thread, reaproveitado entre chamadas: cresce conforme
+// preciso, a cada chamada apenas a parte usada eh zerada, e so eh liberada
+// por unique_release_scratch ou no fim da thread. Com outro alocador a
+// tabela eh alocada dele a cada chamada.
+//
+// No modo bit a bit, elementos de 1 e 2 bytes usam um mapa de bits com uma
+// posicao por valor possivel; os demais usam a tabela com um hash dos bytes.
+//
+// Com um limite de memoria menor que a tabela inteira, o hash eh dividido em
+// faixas, cada uma com uma tabela pequena, e os elementos sao marcados para
+// manter ou nao; faixas que nao couberem ficam para outra passada (veja
+// DedupLimitado).
+
+using byte = graal::detail::byte;
+
+namespace
+{
+	/// Espalha os bits do hash, para que hashes ruins (como a identidade) nao formem sequencias na tabela
+	inline std::uint64_t mistura( std::uint64_t h )
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	/// Hash dos sz bytes de um elemento, 8 bytes por vez
+	inline std::uint64_t hash_bytes( const byte *e, size_t sz )
+	{
+		std::uint64_t h = sz * 0x9e3779b97f4a7c15ull;
+		size_t i = 0;
+		for(; i+8 <= sz; i += 8)
+		{
+			std::uint64_t w;
+			std::memcpy(&w, e+i, 8);
+			h = (h ^ w) * 0x9e3779b97f4a7c15ull;
+			h ^= h >> 29;
+		}
+		if(i < sz)
+		{
+			std::uint64_t w = 0;
+			std::memcpy(&w, e+i, sz-i);
+			h = (h ^ w) * 0x9e3779b97f4a7c15ull;
+		}
+		return h;
+	}
+
+	/// Hash e igualdade dados pelo usuario
+	struct PorFuncao
+	{
+		graal::Hash hash;
+		graal::Equal eq;
+
+		std::uint64_t h( const byte *e ) const { return mistura(hash(e)); }
+		bool igual( const byte *a, const byte *b ) const { return eq(a, b); }
+	};
+
+	/// Hash e igualdade dos bytes de elementos de tamanho N conhecido
+	template < size_t N >
+	struct PorBytes
+	{
+		std::uint64_t h( const byte *e ) const { return mistura(hash_bytes(e, N)); }
+		bool igual( const byte *a, const byte *b ) const { return std::memcmp(a, b, N)==0; }
+	};
+
+	/// Hash e igualdade dos bytes de elementos de tamanho qualquer
+	struct PorBytesVariavel
+	{
+		size_t sz;
+
+		std::uint64_t h( const byte *e ) const { return mistura(hash_bytes(e, sz)); }
+		bool igual( const byte *a, const byte *b ) const { return std::memcmp(a, b, sz)==0; }
+	};
+
+	/// Hash e igualdade dos bits de um campo de U bytes em offset
+	template < typename U >
+	struct PorCampo
+	{
+		size_t offset;
+
+		U le( const byte *e ) const
+		{
+			U x;
+			std::memcpy(&x, e+offset, sizeof(U));
+			return x;
+		}
+
+		std::uint64_t h( const byte *e ) const { return mistura(le(e)); }
+		bool igual( const byte *a, const byte *b ) const { return le(a) == le(b); }
+	};
+
+	/// Tabela de hash da thread, reaproveitada entre chamadas com o alocador padrao
+	thread_local graal::Buffer tabela;
+
+	/* Espaco de tabela de uma chamada. Com o alocador padrao usa a tabela da
+	 * thread; com outro, um buffer proprio alocado de alloc.
+	 */
+	class Tabela
+	{
+		public:
+			/// Zera e retorna espaco para bytes bytes
+			void *zerada( size_t bytes, graal::Allocator &alloc )
+			{
+				graal::Buffer *b = &tabela;
+				if(&alloc != &graal::default_allocator())
+				{
+					m_proprio = graal::Buffer( alloc, bytes );
+					b = &m_proprio;
+				}
+				else if(tabela.size() < bytes)
+				{
+					tabela = graal::Buffer();
+					tabela = graal::Buffer( alloc, bytes );
+				}
+				std::memset(b->data(), 0, bytes);
+				return b->data();
+			}
+
+		private:
+			graal::Buffer m_proprio;
+	};
+
+	/// Entrada da tabela: parte alta do hash e posicao na saida mais 1 (0 = vazia)
+	template < typename I >
+	struct Entrada
+	{
+		I hash;
+		I pos;
+	};
+
+	/* Remove as repeticoes de [first, last) com o nucleo k, o hash/igualdade hi
+	 * e uma tabela de entradas com indices do tipo I. Retorna o fim da saida.
+	 */
+	template < typename I, typename K, typename HI >
+	byte *dedup_tabela( byte *first, byte *last, K k, HI hi, graal::Allocator &alloc )
+	{
+		const size_t sz = k.size();
+		const size_t n = (last-first) / sz;
+
+		// Potencia de 2 com pelo menos o dobro dos elementos
+		size_t cap = 16;
+		while(cap < 2*n)
+			cap *= 2;
+		const size_t mascara = cap-1;
+
+		Tabela espaco;
+		Entrada< I > *t = (Entrada< I > *) espaco.zerada(cap * sizeof(Entrada< I >), alloc);
+
+		byte *out = first;
+		I mantidos = 0;
+		for(byte *it = first; it!=last; it += sz)
+		{
+			std::uint64_t h = hi.h(it);
+			I parte = (I) (h >> 32);
+			size_t i = (size_t) h & mascara;
+
+			for(;;)
+			{
+				Entrada< I > &e = t[i];
+				if(e.pos == 0)
+				{
+					// Valor novo: vai para o fim da saida
+					e.hash = parte;
+					e.pos = ++mantidos;
+					if(out!=it)
+						k.move(out, it);
+					out += sz;
+					break;
+				}
+				if(e.hash == parte && hi.igual(first + (size_t) (e.pos-1)*sz, it))
+					break;
+				i = (i+1) & mascara;
+			}
+		}
+		return out;
+	}
+
+	/// Entradas de cada tabela da primeira passada do modo limitado: o bastante para ficar na cache
+	const size_t ENTRADAS_FAIXA = 1 << 12;
+
+	/// Menor tabela de uma faixa no modo limitado
+	const size_t MIN_ENTRADAS = 16;
+
+	/// Distancia, em elementos, do prefetch das tabelas no modo limitado
+	const size_t ADIANTE = 8;
+
+	/* Remocao de repeticoes com memoria limitada. Os elementos nao saem do
+	 * lugar ate o fim: um mapa de bits marca quais devem ser mantidos. O hash
+	 * eh dividido em faixas pelos seus bits altos (valores iguais caem sempre
+	 * na mesma) e o orcamento em tabelas de hash pequenas, uma por faixa e
+	 * proporcional a sua largura. Uma passada leva cada elemento a tabela da
+	 * sua faixa, que diz se o valor ja apareceu; se todos os valores
+	 * distintos couberem, basta ela, com uma chamada de hash por elemento.
+	 * Uma tabela com mais de 15/16 ocupados divide a faixa durante a passada: a
+	 * metade de cima sai da tabela e fica pendente, a partir da primeira
+	 * posicao em que ela aparece. As passadas seguintes tratam juntas tantas
+	 * pendentes quantas devem caber, pela densidade de valores distintos ja
+	 * vista, comecando na menor das suas posicoes. No fim uma passada compacta
+	 * os marcados, na ordem original.
+	 */
+	template < typename I, typename K, typename HI >
+	struct DedupLimitado
+	{
+		static const int BITS = 8*sizeof(I);
+
+		/// Elementos a partir de inicio cujo hash comeca pelos bits de prefixo, e a tabela deles
+		struct Faixa
+		{
+			I prefixo;
+			int bits;
+			size_t inicio;
+			Entrada< I > *t;
+			size_t tam;        // 0: faixa abandonada (veja divide)
+			size_t ocupadas;
+		};
+
+		byte *first;
+		size_t n;
+		K k;
+		HI hi;
+		std::uint64_t *manter;
+		Entrada< I > *espaco;
+		size_t cap;
+		std::vector< Faixa > pendentes;
+		std::vector< Faixa > abandonadas;
+		double distintos, largura_feita;
+
+		void marca( size_t j, bool v )
+		{
+			std::uint64_t bit = (std::uint64_t) 1 << (j & 63);
+			if(v)
+				manter[j >> 6] |= bit;
+			else
+				manter[j >> 6] &= ~bit;
+		}
+
+		bool marcado( size_t j ) const { return manter[j >> 6] >> (j & 63) & 1; }
+
+		I parte( const byte *e ) const { return (I) (hi.h(e) >> (64-BITS)); }
+
+		static bool na_faixa( I h, I prefixo, int bits )
+		{
+			return bits==0 || (I) (h >> (BITS-bits)) == prefixo;
+		}
+
+		/// Primeiro e ultimo hash da faixa
+		static I base( const Faixa &f ) { return f.bits==0 ? 0 : (I) (f.prefixo << (BITS-f.bits)); }
+		static I topo( const Faixa &f ) { return f.bits==BITS ? f.prefixo : (I) (base(f) | ((I) ~(I) 0 >> f.bits)); }
+
+		static double largura( const Faixa &f ) { return std::ldexp(1.0, -f.bits); }
+
+		/* Sondagem linear: as entradas seguidas estao na mesma linha de cache,
+		 * entao a tabela aguenta ate 15/16. Sempre sobra uma posicao vazia.
+		 */
+		static bool cheia( const Faixa &f ) { return 16*(f.ocupadas+1) > 15*f.tam; }
+
+		/// Metade de cima de f, que fica com a de baixo
+		static Faixa corta( Faixa &f )
+		{
+			Faixa cima{ (I) (f.prefixo*2+1), f.bits+1, f.inicio, nullptr, 0, 0 };
+			f.prefixo = (I) (f.prefixo*2);
+			++f.bits;
+			return cima;
+		}
+
+		/// Posicao inicial de h numa tabela de tam entradas; mistura de novo pois os bits altos se repetem na faixa
+		static size_t casa( I h, size_t tam )
+		{
+			std::uint64_t x = ((std::uint64_t) h * 0x9e3779b97f4a7c15ull) >> 32;
+			return (size_t) ((x * tam) >> 32);
+		}
+
+		/// Marca o elemento j, de hash h, para manter se seu valor ainda nao estiver na tabela de f
+		void decide( Faixa &f, size_t j, I h )
+		{
+			const size_t sz = k.size();
+			const byte *e = first + j*sz;
+			for(size_t i = casa(h, f.tam);; )
+			{
+				Entrada< I > &s = f.t[i];
+				if(s.pos == 0)
+				{
+					s.hash = h;
+					s.pos = (I) (j+1);
+					++f.ocupadas;
+					return marca(j, true);
+				}
+				if(s.hash == h && hi.igual(first + (size_t) (s.pos-1)*sz, e))
+					return marca(j, false);
+				if(++i == f.tam)
+					i = 0;
+			}
+		}
+
+		/* Tira da tabela de f as entradas fora da faixa, guardando em inicio a
+		 * menor posicao delas, e reinsere as demais. A volta comeca depois de
+		 * uma posicao vazia, para que cada sequencia seja refeita do comeco.
+		 */
+		void refaz( Faixa &f, size_t &inicio )
+		{
+			size_t vazia = 0;
+			while(f.t[vazia].pos != 0)
+				++vazia;
+
+			f.ocupadas = 0;
+			for(size_t c = 1; c < f.tam; ++c)
+			{
+				size_t i = vazia+c < f.tam ? vazia+c : vazia+c-f.tam;
+				Entrada< I > s = f.t[i];
+				if(s.pos == 0)
+					continue;
+
+				f.t[i].pos = 0;
+				if(!na_faixa(s.hash, f.prefixo, f.bits))
+				{
+					inicio = (size_t) s.pos-1 < inicio ? (size_t) s.pos-1 : inicio;
+					continue;
+				}
+
+				size_t d = casa(s.hash, f.tam);
+				while(f.t[d].pos != 0)
+					if(++d == f.tam)
+						d = 0;
+				f.t[d] = s;
+				++f.ocupadas;
+			}
+		}
+
+		/// Tabela de f cheia no elemento j: divide a faixa ate que caiba, deixando as metades de cima pendentes
+		void divide( Faixa &f, size_t j )
+		{
+			while(cheia(f))
+			{
+				// Valores demais com o hash inteiro igual: nao ha como dividir
+				if(f.bits == BITS)
+				{
+					abandonadas.push_back(f);
+					f.tam = 0;
+					return;
+				}
+
+				Faixa cima = corta(f);
+				cima.inicio = j+1;
+				refaz(f, cima.inicio);
+				pendentes.push_back(cima);
+			}
+		}
+
+		/// Uma passada pelos elementos, com as faixas de ativas (ordenadas pelo hash)
+		void rodada( std::vector< Faixa > &ativas )
+		{
+			// MIN_ENTRADAS para cada faixa e o resto do espaco proporcional as larguras
+			double total = 0;
+			for(const Faixa &f : ativas)
+				total += largura(f);
+
+			const size_t resto = cap - ativas.size()*MIN_ENTRADAS;
+			double acumulada = 0;
+			size_t antes = 0, inicio = n;
+			Entrada< I > *t = espaco;
+			for(size_t a = 0; a < ativas.size(); ++a)
+			{
+				Faixa &f = ativas[a];
+				acumulada += largura(f);
+				size_t ate = a+1 == ativas.size() ? resto : (size_t) (resto * (acumulada / total));
+				ate = ate < antes ? antes : ate > resto ? resto : ate;
+
+				f.t = t;
+				f.tam = MIN_ENTRADAS + (ate-antes);
+				f.ocupadas = 0;
+				t += f.tam;
+				antes = ate;
+				inicio = f.inicio < inicio ? f.inicio : inicio;
+			}
+			std::memset(espaco, 0, cap * sizeof(Entrada< I >));
+
+			/* Hashes de [menor, maior] em celulas de 2^desloca, ate 4 por faixa;
+			 * a primeira faixa que pode conter um hash da celula c eh prim[c]
+			 */
+			const I menor = base(ativas.front()), maior = topo(ativas.back());
+			int desloca = 0;
+			while((size_t) ((maior-menor) >> desloca) >= 4*ativas.size())
+				++desloca;
+			std::vector< size_t > prim( (size_t) ((maior-menor) >> desloca) + 1 );
+			for(size_t a = 0, c = 0; c < prim.size(); ++c)
+			{
+				while(a < ativas.size() && (size_t) ((topo(ativas[a])-menor) >> desloca) < c)
+					++a;
+				prim[c] = a;
+			}
+
+			auto acha = [&]( I h ) -> Faixa *
+			{
+				for(size_t a = prim[(size_t) ((h-menor) >> desloca)]; a < ativas.size() && base(ativas[a]) <= h; ++a)
+					if(ativas[a].tam != 0 && na_faixa(h, ativas[a].prefixo, ativas[a].bits))
+						return &ativas[a];
+				return nullptr;
+			};
+
+			/* Cada elemento de uma faixa ativa eh decidido so depois de achados
+			 * os ADIANTE seguintes, com a sua posicao na tabela ja pedida. Se a
+			 * faixa for dividida nesse meio tempo o elemento pode ter ficado
+			 * para uma pendente.
+			 */
+			struct Achado
+			{
+				I h;
+				Faixa *f;
+				size_t j;
+			};
+			Achado fila[ADIANTE];
+			size_t cabeca = 0, na_fila = 0;
+
+			auto trata = [this]( const Achado &a )
+			{
+				if(a.f->tam == 0 || !na_faixa(a.h, a.f->prefixo, a.f->bits))
+					return;
+				decide(*a.f, a.j, a.h);
+				if(cheia(*a.f))
+					divide(*a.f, a.j);
+			};
+
+			const size_t sz = k.size();
+			for(size_t j = inicio; j < n; ++j)
+			{
+				// Na maioria das passadas quase todos os elementos ficam fora de [menor, maior]
+				I h = parte(first + j*sz);
+				if((I) (h-menor) > (I) (maior-menor))
+					continue;
+				Faixa *f = acha(h);
+				if(!f)
+					continue;
+				__builtin_prefetch(f->t + casa(h, f->tam));
+
+				if(na_fila == ADIANTE)
+					trata(fila[cabeca]);
+				else
+					++na_fila;
+				fila[cabeca] = Achado{ h, f, j };
+				cabeca = (cabeca+1) % ADIANTE;
+			}
+			for(size_t i = ADIANTE - na_fila; i < ADIANTE; ++i)
+				trata(fila[(cabeca+i) % ADIANTE]);
+
+			for(const Faixa &f : ativas)
+			{
+				if(f.tam == 0)
+					continue;
+				distintos += f.ocupadas;
+				largura_feita += largura(f);
+			}
+		}
+
+		/// Hash igual em todos os bits e valores demais: compara com os ja mantidos desse hash
+		void quadratico( I h0, size_t inicio )
+		{
+			const size_t sz = k.size();
+			for(size_t j = inicio; j < n; ++j)
+			{
+				const byte *it = first + j*sz;
+				if(parte(it) != h0)
+					continue;
+
+				bool novo = true;
+				for(size_t m = inicio; m < j && novo; ++m)
+					if(marcado(m) && parte(first + m*sz) == h0 && hi.igual(first + m*sz, it))
+						novo = false;
+				marca(j, novo);
+			}
+		}
+
+		/* Processa as 2^bits faixas iniciais e depois as pendentes que surgirem.
+		 * Cada passada seguinte leva as pendentes, na ordem do hash, enquanto
+		 * os valores distintos esperados ocuparem ate 7/8 das entradas; antes
+		 * as pendentes sao divididas em pedacos de ate 1/8 disso, para que a
+		 * passada chegue perto dos 7/8.
+		 */
+		void processa( int bits )
+		{
+			std::vector< Faixa > ativas;
+			for(std::uint64_t p = 0; p < ((std::uint64_t) 1 << bits); ++p)
+				ativas.push_back(Faixa{ (I) p, bits, 0, nullptr, 0, 0 });
+
+			for(;;)
+			{
+				rodada(ativas);
+				if(pendentes.empty())
+					break;
+
+				const double alvo = cap * 7.0 / 8;
+				const double densidade = largura_feita > 0 ? distintos / largura_feita : (double) n;
+				for(size_t i = 0; i < pendentes.size(); ++i)
+					while(largura(pendentes[i]) * densidade > alvo/8 && pendentes[i].bits < BITS)
+						pendentes.push_back(corta(pendentes[i]));
+				std::sort(pendentes.begin(), pendentes.end(), []( const Faixa &a, const Faixa &b ) { return base(a) < base(b); });
+
+				size_t leva = 1;
+				double esperados = largura(pendentes[0]) * densidade;
+				while(leva < pendentes.size() && leva < cap/MIN_ENTRADAS
+						&& esperados + largura(pendentes[leva]) * densidade <= alvo)
+					esperados += largura(pendentes[leva++]) * densidade;
+				ativas.assign(pendentes.begin(), pendentes.begin()+leva);
+				pendentes.erase(pendentes.begin(), pendentes.begin()+leva);
+			}
+
+			for(const Faixa &f : abandonadas)
+				quadratico(f.prefixo, f.inicio);
+		}
+
+		/// Move os marcados para o inicio, na ordem original
+		byte *compacta()
+		{
+			const size_t sz = k.size();
+			byte *out = first;
+			for(size_t j = 0; j < n; ++j)
+			{
+				if(!marcado(j))
+					continue;
+				byte *it = first + j*sz;
+				if(out!=it)
+					k.move(out, it);
+				out += sz;
+			}
+			return out;
+		}
+	};
+
+	template < typename I, typename K, typename HI >
+	byte *dedup_limitado( byte *first, byte *last, K k, HI hi, size_t memoria, graal::Allocator &alloc )
+	{
+		const size_t n = (last-first) / k.size();
+
+		// Tabela inteira cabe no orcamento: caminho normal
+		size_t cap = 16;
+		while(cap < 2*n)
+			cap *= 2;
+		if(cap * sizeof(Entrada< I >) <= memoria)
+			return dedup_tabela< I >(first, last, k, hi, alloc);
+
+		// O mapa de bits eh obrigatorio; o resto do orcamento vai para as tabelas das faixas
+		const size_t bytes_mapa = (n+63) / 64 * 8;
+		if(memoria < bytes_mapa + MIN_ENTRADAS * sizeof(Entrada< I >))
+			throw std::invalid_argument( "graal: max_memory menor que o minimo de unique" );
+		cap = (memoria - bytes_mapa) / sizeof(Entrada< I >);
+		if(cap > 2*n)
+			cap = 2*n;
+		if(cap > UINT32_MAX)
+			cap = UINT32_MAX;
+
+		// Faixas da primeira passada com cerca de ENTRADAS_FAIXA entradas cada
+		int bits = 0;
+		while(bits < 16 && (cap >> bits) >= 2*ENTRADAS_FAIXA)
+			++bits;
+
+		graal::Buffer mapa( alloc, bytes_mapa );
+		graal::Buffer tabelas( alloc, cap * sizeof(Entrada< I >) );
+		DedupLimitado< I, K, HI > d{ first, n, k, hi, mapa.as< std::uint64_t >(),
+			tabelas.as< Entrada< I > >(), cap, {}, {}, 0, 0 };
+
+		d.processa(bits);
+		return d.compacta();
+	}
+
+	/// Escolhe o tamanho dos indices da tabela pela quantidade de elementos
+	template < typename K, typename HI >
+	byte *dedup_limitado( byte *first, byte *last, K k, HI hi, size_t memoria, graal::Allocator &alloc )
+	{
+		if((size_t) (last-first) / k.size() < UINT32_MAX)
+			return dedup_limitado< std::uint32_t >(first, last, k, hi, memoria, alloc);
+		return dedup_limitado< std::uint64_t >(first, last, k, hi, memoria, alloc);
+	}
+
+	/// unique com hash e igualdade do usuario, para o nucleo escolhido por despacha
+	template < typename HI >
+	struct faz_unique
+	{
+		byte *first, *last;
+		HI hi;
+		size_t memoria;
+		graal::Allocator *alloc;
+
+		template < typename K >
+		byte *operator()( K k ) const
+		{
+			return dedup_limitado(first, last, k, hi, memoria, *alloc);
+		}
+	};
+
+	/// unique pelo campo lido por ler, com a tabela de hash
+	struct faz_unique_campo
+	{
+		byte *first, *last;
+		size_t sz;
+		graal::Allocator *alloc;
+
+		template < typename U >
+		byte *operator()( graal::campos::LeCampo< U > ler ) const
+		{
+			// Chaves iguais tem os mesmos bits: a transformacao de ler nao eh necessaria
+			return graal::kernels::despacha( sz, faz_unique< PorCampo< U > >{ first, last, PorCampo< U >{ ler.offset },
+					SIZE_MAX, alloc } );
+		}
+	};
+
+	/// unique sem hash: procura cada elemento entre os ja mantidos
+	struct faz_unique_quadratico
+	{
+		byte *first, *last;
+		graal::Equal eq;
+
+		template < typename K >
+		byte *operator()( K k ) const
+		{
+			const size_t sz = k.size();
+			byte *out = first;
+			for(byte *it = first; it!=last; it += sz)
+			{
+				byte *m = first;
+				while(m!=out && !eq(m, it))
+					m += sz;
+
+				if(m==out)
+				{
+					if(out!=it)
+						k.move(out, it);
+					out += sz;
+				}
+			}
+			return out;
+		}
+	};
+
+	/// unique bit a bit para elementos de 1 ou 2 bytes: um bit por valor possivel
+	template < typename U >
+	byte *dedup_mapa( byte *first, byte *last, graal::Allocator &alloc )
+	{
+		const size_t VALORES = (size_t) 1 << (8*sizeof(U));
+		Tabela espaco;
+		std::uint64_t *visto = (std::uint64_t*) espaco.zerada(VALORES/8, alloc);
+
+		byte *out = first;
+		for(byte *it = first; it!=last; it += sizeof(U))
+		{
+			U v;
+			std::memcpy(&v, it, sizeof(U));
+			std::uint64_t bit = (std::uint64_t) 1 << (v & 63);
+			if(!(visto[v >> 6] & bit))
+			{
+				visto[v >> 6] |= bit;
+				std::memcpy(out, &v, sizeof(U));
+				out += sizeof(U);
+			}
+		}
+		return out;
+	}
+}
+
+/// A funcao remove as repeticoes de [first, last), comparando cada elemento com os ja mantidos
+void *graal::unique( void *first, void *last, size_t sz, Equal eq )
+{
+	return kernels::despacha( sz, faz_unique_quadratico{ (byte*) first, (byte*) last, eq } );
+}
+
+/// A funcao remove as repeticoes de [first, last) comparando com os ja mantidos e movendo os elementos com ops
+void *graal::unique( void *first, void *last, size_t sz, Equal eq, const TypeOps &ops )
+{
+	return faz_unique_quadratico{ (byte*) first, (byte*) last, eq }( kernels::Operacoes{ &ops, sz } );
+}
+
+/// A funcao remove as repeticoes de [first, last) usando uma tabela de hash
+void *graal::unique( void *first, void *last, size_t sz, Hash hash, Equal eq, Allocator &alloc )
+{
+	return unique(first, last, sz, hash, eq, SIZE_MAX, alloc);
+}
+
+/// A funcao remove as repeticoes de [first, last) usando no maximo max_memory bytes
+void *graal::unique( void *first, void *last, size_t sz, Hash hash, Equal eq, size_t max_memory,
+		Allocator &alloc )
+{
+	if(first==last)
+		return last;
+	return kernels::despacha( sz, faz_unique< PorFuncao >{ (byte*) first, (byte*) last, PorFuncao{ hash, eq },
+			max_memory, &alloc } );
+}
+
+/// A funcao remove as repeticoes de [first, last) com uma tabela de hash, movendo os elementos com ops
+void *graal::unique( void *first, void *last, size_t sz, Hash hash, Equal eq, const TypeOps &ops )
+{
+	if(first==last)
+		return last;
+	return faz_unique< PorFuncao >{ (byte*) first, (byte*) last, PorFuncao{ hash, eq }, SIZE_MAX,
+			&default_allocator() }( kernels::Operacoes{ &ops, sz } );
+}
+
+/// A funcao remove as repeticoes de [first, last), sendo iguais os elementos com os mesmos bytes
+void *graal::unique( void *first, void *last, size_t sz, Bitwise, Allocator &alloc )
+{
+	return unique(first, last, sz, bitwise, SIZE_MAX, alloc);
+}
+
+/// A funcao remove as repeticoes de [first, last) com os mesmos bytes usando no maximo max_memory bytes
+void *graal::unique( void *first, void *last, size_t sz, Bitwise, size_t max_memory, Allocator &alloc )
+{
+	byte *it = (byte*) first;
+	byte *at = (byte*) last;
+	if(it==at)
+		return last;
+
+	switch(sz)
+	{
+		// O mapa de bits tem no maximo 8KB, independente do orcamento
+		case 1:  return dedup_mapa< std::uint8_t >(it, at, alloc);
+		case 2:  return dedup_mapa< std::uint16_t >(it, at, alloc);
+		case 4:  return dedup_limitado(it, at, kernels::Fixo< 4 >(), PorBytes< 4 >(), max_memory, alloc);
+		case 8:  return dedup_limitado(it, at, kernels::Fixo< 8 >(), PorBytes< 8 >(), max_memory, alloc);
+		case 16: return dedup_limitado(it, at, kernels::Fixo< 16 >(), PorBytes< 16 >(), max_memory, alloc);
+	}
+
+	if(sz % 8 == 0)
+		return dedup_limitado(it, at, kernels::Palavras{ sz }, PorBytesVariavel{ sz }, max_memory, alloc);
+	return dedup_limitado(it, at, kernels::Blocos{ sz }, PorBytesVariavel{ sz }, max_memory, alloc);
+}
+
+/// A funcao libera a tabela de hash que unique mantem na thread que chama
+void graal::unique_release_scratch()
+{
+	tabela = Buffer();
+}
+
+/// A funcao remove os elementos cuja chave, lida do campo descrito por key, ja apareceu antes
+void *graal::unique( void *first, void *last, size_t sz, Key key, Allocator &alloc )
+{
+	if(first==last)
+		return last;
+	return campos::despacha( key, faz_unique_campo{ (byte*) first, (byte*) last, sz, &alloc } );
+}
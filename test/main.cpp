@@ -1,6 +1,12 @@
 #include <iterator>             // std::begin(), std::end()
 #include <functional>           // std::function
 #include <algorithm>            // std::min_element
+#include <vector>               // std::vector
+#include <cstring>              // std::memcmp
+#include <cmath>                // NAN
+#include <cstdint>              // std::uintptr_t
+#include <cstddef>              // offsetof
+#include <stdexcept>            // std::invalid_argument, std::runtime_error
 
 #include "gtest/gtest.h"        // gtest lib
 #include "../include/graal.h"   // header file for tested functions
@@ -1347,6 +1353,1472 @@ TEST(StringRange, PartAreNotEqualType2)
 /*}}}*/
 /*}}}*/
 
+// ============================================================================
+//                                                   Tests for the typed layer
+// ============================================================================
+/*{{{*/
+/* TypedRange -> min() tests {{{*/
+TEST(TypedRange, MinBasic)
+{
+    int A[]{ 1, 2, -3, 4, 0 };
+
+    auto result = graal::min( std::begin(A), std::end(A),
+            []( int a, int b ) { return a < b; } );
+    ASSERT_EQ( result , std::begin(A)+2 );
+}
+
+TEST(TypedRange, MinFirstOcurrence)
+{
+    std::string A[]{ "ano", "sal", "ano", "re" };
+
+    auto result = graal::min( std::begin(A), std::end(A),
+            []( const std::string &a, const std::string &b ) { return a < b; } );
+    ASSERT_EQ( result , std::begin(A) );
+}
+/*}}}*/
+/* TypedRange -> find_if() / find() tests {{{*/
+TEST(TypedRange, FindIfLotsAreBiggerThan)
+{
+	int A[]{ -10, -3, -4, 5, 7, 4 };
+	auto result = graal::find_if( std::begin(A), std::end(A), []( int a ) { return a > 1; } );
+	ASSERT_EQ( std::begin(A)+3, result );
+}
+
+TEST(TypedRange, FindNoneIsEqual)
+{
+	char A[]{ 'a', 'b', 'c', 'd', 'e' };
+	auto result = graal::find( std::begin(A), std::end(A), 'k' );
+	ASSERT_EQ( std::end(A), result );
+}
+/*}}}*/
+/* TypedRange -> all_of() / any_of() / none_of() tests {{{*/
+TEST(TypedRange, QuantifiersBiggerThan)
+{
+    int A[]{ 1, 1, 1, 10, 1 };
+    auto bigg_than = []( int a ) { return a > 1; };
+
+    ASSERT_FALSE( graal::all_of( std::begin(A), std::end(A), bigg_than ) );
+    ASSERT_TRUE( graal::any_of( std::begin(A), std::end(A), bigg_than ) );
+    ASSERT_FALSE( graal::none_of( std::begin(A), std::end(A), bigg_than ) );
+}
+
+TEST(TypedRange, QuantifiersEmptyRange)
+{
+    int A[]{ 1 };
+    auto bigg_than = []( int a ) { return a > 1; };
+
+    ASSERT_TRUE( graal::all_of( std::begin(A), std::begin(A), bigg_than ) );
+    ASSERT_FALSE( graal::any_of( std::begin(A), std::begin(A), bigg_than ) );
+    ASSERT_TRUE( graal::none_of( std::begin(A), std::begin(A), bigg_than ) );
+}
+/*}}}*/
+/* TypedRange -> partition() tests {{{*/
+TEST(TypedRange, PartitionSomeAreTrue)
+{
+	std::string A[]{ "a", "cc", "b", "dd", "e" };
+
+	auto result = graal::partition( std::begin(A), std::end(A),
+			[]( const std::string &s ) { return s.size() > 1; } );
+	ASSERT_EQ( result, std::begin(A)+2 );
+	ASSERT_TRUE( std::all_of( std::begin(A), result,
+			[]( const std::string &s ) { return s.size() > 1; } ) );
+}
+/*}}}*/
+/*}}}*/
+
+// ============================================================================
+//                                                       Tests for record sizes
+// ============================================================================
+/*{{{*/
+/* Record with a size that is a multiple of 8 */
+struct Rec24 { long long key; long long a; long long b; };
+
+/* Record with an irregular size */
+struct Rec3 { char c[3]; };
+
+bool REC24_odd( const void *r )
+{
+    return static_cast< const Rec24 * >(r)->key % 2 != 0;
+}
+
+/* RecordRange -> reverse() / partition() tests {{{*/
+TEST(RecordRange, ReverseMultipleOf8)
+{
+    Rec24 A[]{ { 1, 1, 1 }, { 2, 2, 2 }, { 3, 3, 3 }, { 4, 4, 4 }, { 5, 5, 5 } };
+
+    graal::reverse( std::begin(A), std::end(A), sizeof(A[0]) );
+    for( int i = 0; i < 5; ++i )
+        ASSERT_TRUE( A[i].key == 5-i && A[i].a == 5-i && A[i].b == 5-i );
+}
+
+TEST(RecordRange, ReverseIrregularSize)
+{
+    Rec3 A[]{ { {'a','b','c'} }, { {'d','e','f'} }, { {'g','h','i'} }, { {'j','k','l'} } };
+
+    graal::reverse( std::begin(A), std::end(A), sizeof(A[0]) );
+    ASSERT_EQ( 0, std::memcmp( A, "jklghidefabc", sizeof(A) ) );
+}
+
+TEST(RecordRange, PartitionMultipleOf8)
+{
+    Rec24 A[]{ { 2, 0, 0 }, { 3, 3, 3 }, { 4, 0, 0 }, { 5, 5, 5 }, { 7, 7, 7 } };
+
+    auto result = static_cast< Rec24 * >(
+            graal::partition( std::begin(A), std::end(A), sizeof(A[0]), REC24_odd ) );
+    ASSERT_EQ( result, std::begin(A)+3 );
+    for( auto it = std::begin(A); it != result; ++it )
+        ASSERT_TRUE( it->key % 2 != 0 && it->a == it->key && it->b == it->key );
+}
+/*}}}*/
+/*}}}*/
+
+// ============================================================================
+//                                                    Tests for bitwise find()
+// ============================================================================
+/*{{{*/
+TEST(BitwiseFind, FirstOcurrenceInLongRange)
+{
+    std::vector< int > A( 1000, 7 );
+    A[700] = 42;
+    A[900] = 42;
+    int alvo = 42;
+
+    auto result = graal::find( A.data(), A.data()+A.size(), sizeof(int), &alvo, graal::bitwise );
+    ASSERT_EQ( result, A.data()+700 );
+}
+
+TEST(BitwiseFind, NoneIsEqual)
+{
+    long long A[]{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    long long alvo = 1LL << 32 | 1;
+
+    auto result = graal::find( std::begin(A), std::end(A), sizeof(A[0]), &alvo, graal::bitwise );
+    ASSERT_EQ( result, std::end(A) );
+}
+
+TEST(BitwiseFind, IrregularSize)
+{
+    Rec3 A[]{ { {'a','b','c'} }, { {'d','e','f'} }, { {'d','e','g'} } };
+    Rec3 alvo{ {'d','e','g'} };
+
+    auto result = graal::find( std::begin(A), std::end(A), sizeof(A[0]), &alvo, graal::bitwise );
+    ASSERT_EQ( result, std::begin(A)+2 );
+}
+/*}}}*/
+
+// ============================================================================
+//                                             Tests for equal() and mismatch()
+// ============================================================================
+/*{{{*/
+TEST(Mismatch, FirstDifferingPair)
+{
+    int A[]{ 1, 2, 3, 4, 5 };
+    int B[]{ 1, 2, 7, 4, 9 };
+
+    auto r = graal::mismatch( std::begin(A), std::end(A), std::begin(B), sizeof(int), INT_equal_to );
+    ASSERT_EQ( r.first, std::begin(A)+2 );
+    ASSERT_EQ( r.second, std::begin(B)+2 );
+
+    r = graal::mismatch( std::begin(A), std::end(A), std::begin(B), sizeof(int), graal::bitwise );
+    ASSERT_EQ( r.first, std::begin(A)+2 );
+    ASSERT_EQ( r.second, std::begin(B)+2 );
+
+    // Equal prefixes: stops at the end of the shorter range
+    r = graal::mismatch( std::begin(A), std::begin(A)+2, std::begin(B), std::end(B), sizeof(int), INT_equal_to );
+    ASSERT_EQ( r.first, std::begin(A)+2 );
+    ASSERT_EQ( r.second, std::begin(B)+2 );
+}
+
+TEST(Mismatch, DifferentLengthsAreNotEqual)
+{
+    int A[]{ 1, 2, 3 };
+    int B[]{ 1, 2, 3, 4 };
+
+    ASSERT_FALSE( graal::equal( std::begin(A), std::end(A), std::begin(B), std::end(B), sizeof(int), INT_equal_to ) );
+    ASSERT_FALSE( graal::equal( std::begin(A), std::end(A), std::begin(B), std::end(B), sizeof(int), graal::bitwise ) );
+    ASSERT_TRUE( graal::equal( std::begin(A), std::end(A), std::begin(B), std::begin(B)+3, sizeof(int), graal::bitwise ) );
+    ASSERT_TRUE( graal::equal( std::begin(A), std::begin(A), std::begin(B), sizeof(int), graal::bitwise ) );
+}
+
+TEST(Mismatch, BitwiseLargeBuffers)
+{
+    // Records of 12 bytes: the result points to the record holding the first differing byte
+    struct Rec { int a, b, c; };
+    std::vector< Rec > A( 5000 );
+    for(size_t i = 0; i < A.size(); ++i)
+        A[i] = Rec{ int(i), int(i*3), -int(i) };
+
+    for(size_t pos : { size_t(0), size_t(1), size_t(37), size_t(2500), size_t(4999) })
+    {
+        std::vector< Rec > B = A;
+        B[pos].c = 1;
+        const Rec *fa = A.data(), *la = A.data()+A.size();
+
+        ASSERT_FALSE( graal::equal( fa, la, B.data(), sizeof(Rec), graal::bitwise ) );
+        auto r = graal::mismatch( fa, la, B.data(), sizeof(Rec), graal::bitwise );
+        ASSERT_EQ( r.first, fa+pos );
+        ASSERT_EQ( r.second, B.data()+pos );
+
+        B[pos] = A[pos];
+        ASSERT_TRUE( graal::equal( fa, la, B.data(), B.data()+B.size(), sizeof(Rec), graal::bitwise ) );
+        ASSERT_EQ( graal::mismatch( fa, la, B.data(), sizeof(Rec), graal::bitwise ).first, la );
+    }
+}
+/*}}}*/
+
+// ============================================================================
+//                                                Tests for search(), search_n()
+// ============================================================================
+/*{{{*/
+TEST(Search, FindsSubsequence)
+{
+    int A[]{ 1, 2, 3, 1, 2, 4, 1, 2, 4, 5 };
+    int S[]{ 1, 2, 4 };
+
+    ASSERT_EQ( graal::search( std::begin(A), std::end(A), std::begin(S), std::end(S), sizeof(int), INT_equal_to ), std::begin(A)+3 );
+    ASSERT_EQ( graal::search( std::begin(A), std::end(A), std::begin(S), std::end(S), sizeof(int), graal::bitwise ), std::begin(A)+3 );
+
+    // Empty pattern matches at first; missing or longer pattern returns last
+    ASSERT_EQ( graal::search( std::begin(A), std::end(A), std::begin(S), std::begin(S), sizeof(int), graal::bitwise ), std::begin(A) );
+    int T[]{ 4, 2 };
+    ASSERT_EQ( graal::search( std::begin(A), std::end(A), std::begin(T), std::end(T), sizeof(int), graal::bitwise ), std::end(A) );
+    ASSERT_EQ( graal::search( std::begin(S), std::end(S), std::begin(A), std::end(A), sizeof(int), INT_equal_to ), std::end(S) );
+}
+
+TEST(Search, BitwiseMatchesStdSearch)
+{
+    std::srand( 5 );
+    for(int rodada = 0; rodada < 200; ++rodada)
+    {
+        // Small alphabet so that partial matches are frequent
+        std::vector< char > A( 300 + std::rand() % 200 );
+        for(auto &c : A)
+            c = 'a' + std::rand() % 3;
+        size_t m = 2 + std::rand() % 6;
+        size_t at = std::rand() % (A.size() - m);
+        std::vector< char > S( A.begin() + at, A.begin() + at + m );
+        if(rodada % 4 == 0)
+            S[m-1] = 'z';
+
+        const char *esperado = &*std::search( A.begin(), A.end(), S.begin(), S.end() );
+        if(std::search( A.begin(), A.end(), S.begin(), S.end() ) == A.end())
+            esperado = A.data() + A.size();
+        ASSERT_EQ( graal::search( A.data(), A.data()+A.size(), S.data(), S.data()+S.size(), 1, graal::bitwise ), esperado );
+
+        // Same data as 3-byte records: matches must be aligned to records
+        size_t n3 = A.size() / 3, m3 = 1 + m / 3;
+        size_t at3 = std::rand() % (n3 - m3);
+        const char *r = static_cast< const char * >( graal::search( A.data(), A.data() + n3*3,
+                A.data() + at3*3, A.data() + (at3+m3)*3, 3, graal::bitwise ) );
+        ASSERT_EQ( (r - A.data()) % 3, 0 );
+        ASSERT_LE( r, A.data() + at3*3 );
+        ASSERT_EQ( std::memcmp( r, A.data() + at3*3, m3*3 ), 0 );
+    }
+}
+
+TEST(Search, SearchNMatchesStd)
+{
+    std::srand( 9 );
+    for(int rodada = 0; rodada < 200; ++rodada)
+    {
+        std::vector< int > A( 1 + std::rand() % 100 );
+        for(auto &x : A)
+            x = std::rand() % 4 == 0 ? 1 : 0;
+        size_t count = std::rand() % 5;
+        int value = 0;
+
+        auto it = std::search_n( A.begin(), A.end(), count, value );
+        const int *esperado = A.data() + (it - A.begin());
+        ASSERT_EQ( graal::search_n( A.data(), A.data()+A.size(), count, &value, sizeof(int), INT_equal_to ), esperado );
+        ASSERT_EQ( graal::search_n( A.data(), A.data()+A.size(), count, &value, sizeof(int), graal::bitwise ), esperado );
+    }
+}
+/*}}}*/
+
+// ============================================================================
+//                                           Tests for typed min/max/minmax()
+// ============================================================================
+/*{{{*/
+TEST(PrimitiveRange, MinFirstOcurrence)
+{
+    std::vector< int > A( 1000, 5 );
+    A[300] = -7;
+    A[800] = -7;
+
+    auto result = graal::min( A.data(), A.data()+A.size(), sizeof(int), graal::ElementType::Int32 );
+    ASSERT_EQ( result, A.data()+300 );
+}
+
+TEST(PrimitiveRange, MaxUnsignedBytes)
+{
+    unsigned char A[]{ 1, 200, 3, 255, 4, 255, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+
+    auto result = graal::max( std::begin(A), std::end(A), sizeof(A[0]), graal::ElementType::UInt8 );
+    ASSERT_EQ( result, std::begin(A)+3 );
+}
+
+TEST(PrimitiveRange, MinMaxIgnoresNaN)
+{
+    double A[]{ NAN, 2.5, NAN, -1.0, 8.0, NAN, -1.0, 8.0 };
+
+    auto result = graal::minmax( std::begin(A), std::end(A), sizeof(A[0]), graal::ElementType::Double );
+    ASSERT_EQ( result.first, std::begin(A)+3 );
+    ASSERT_EQ( result.second, std::begin(A)+4 );
+}
+
+TEST(PrimitiveRange, SizeMustMatchType)
+{
+    short A[]{ 3, 1, 2 };
+
+    ASSERT_EQ( graal::element_size( graal::ElementType::Int16 ), sizeof(short) );
+    ASSERT_EQ( graal::element_size( graal::ElementType::Double ), sizeof(double) );
+    ASSERT_THROW( graal::min( std::begin(A), std::end(A), sizeof(short), graal::ElementType::Int32 ), std::invalid_argument );
+    ASSERT_THROW( graal::minmax( std::begin(A), std::end(A), sizeof(short), graal::ElementType::UInt8 ), std::invalid_argument );
+    ASSERT_EQ( graal::max( std::begin(A), std::end(A), sizeof(short), graal::ElementType::Int16 ), std::begin(A) );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                      Tests for scan_stats()
+// ============================================================================
+/*{{{*/
+TEST(ScanStats, MatchesSeparatePasses)
+{
+    int A[]{ 3, 1, 9, 1, -4, 9, 2, 7, -4, 0 };
+    const int *f = std::begin(A), *l = std::end(A);
+
+    auto r = graal::scan_stats( f, l, sizeof(int), graal::ScanSpec( INT_sort_comp, INT_bigg_than ) );
+    ASSERT_EQ( r.min, graal::min( f, l, sizeof(int), INT_sort_comp ) );
+    ASSERT_EQ( r.min, f+4 );
+    ASSERT_EQ( r.max, f+2 );
+    ASSERT_EQ( r.first_match, graal::find_if( f, l, sizeof(int), INT_bigg_than ) );
+    ASSERT_EQ( r.last_match, f+7 );
+    ASSERT_EQ( r.count, 5u );
+    ASSERT_EQ( r.size, 10u );
+    ASSERT_EQ( r.any_of(), graal::any_of( f, l, sizeof(int), INT_bigg_than ) );
+    ASSERT_EQ( r.all_of(), graal::all_of( f, l, sizeof(int), INT_bigg_than ) );
+    ASSERT_EQ( r.none_of(), graal::none_of( f, l, sizeof(int), INT_bigg_than ) );
+
+    // Last occurrence of the largest element, as std::minmax_element
+    r = graal::scan_stats( f, l, sizeof(int), graal::ScanSpec( INT_sort_comp, nullptr, true ) );
+    ASSERT_EQ( r.min, f+4 );
+    ASSERT_EQ( r.max, f+5 );
+    ASSERT_EQ( r.first_match, l );
+    ASSERT_EQ( r.count, 0u );
+}
+
+TEST(ScanStats, OnlyPredicateAndEmptyRange)
+{
+    int A[]{ 0, 1, 0, 1 };
+    const int *f = std::begin(A), *l = std::end(A);
+
+    auto r = graal::scan_stats( f, l, sizeof(int), graal::ScanSpec( nullptr, INT_bigg_than ) );
+    ASSERT_EQ( r.min, l );
+    ASSERT_EQ( r.max, l );
+    ASSERT_EQ( r.first_match, l );
+    ASSERT_EQ( r.last_match, l );
+    ASSERT_TRUE( r.none_of() );
+    ASSERT_FALSE( r.all_of() );
+
+    r = graal::scan_stats( f, f, sizeof(int), graal::ScanSpec( INT_sort_comp, INT_bigg_than ) );
+    ASSERT_EQ( r.min, f );
+    ASSERT_EQ( r.first_match, f );
+    ASSERT_EQ( r.size, 0u );
+    ASSERT_TRUE( r.all_of() );
+    ASSERT_FALSE( r.any_of() );
+}
+/*}}}*/
+
+// ============================================================================
+//                                     Tests for overlapping copies and moves
+// ============================================================================
+/*{{{*/
+TEST(OverlapRange, CopyBackwardToTheRight)
+{
+    int A[]{ 1, 2, 3, 4, 5, 0, 0 };
+    int A_E[]{ 1, 2, 1, 2, 3, 4, 5 };
+
+    auto result = graal::copy_backward( std::begin(A), std::begin(A)+5, std::end(A), sizeof(A[0]) );
+    ASSERT_EQ( result, std::begin(A)+2 );
+    ASSERT_TRUE( std::equal( std::begin(A), std::end(A), std::begin(A_E) ) );
+}
+
+TEST(OverlapRange, MoveToTheLeft)
+{
+    char A[]{ 'x', 'x', 'a', 'b', 'c', 'd' };
+    char A_E[]{ 'a', 'b', 'c', 'd', 'c', 'd' };
+
+    auto result = graal::move( std::begin(A)+2, std::end(A), std::begin(A), sizeof(A[0]) );
+    ASSERT_EQ( result, std::begin(A)+4 );
+    ASSERT_TRUE( std::equal( std::begin(A), std::end(A), std::begin(A_E) ) );
+}
+
+TEST(OverlapRange, StreamingMoveToTheRight)
+{
+    std::vector< int > A( 10000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = i;
+
+    graal::move( A.data(), A.data()+9000, A.data()+1000, sizeof(int), graal::CopyMode::Streaming );
+    for( size_t i = 1000; i < A.size(); ++i )
+        ASSERT_EQ( A[i], (int) i-1000 );
+}
+/*}}}*/
+
+// ============================================================================
+//                                          Tests for Arena, Buffer and clone()
+// ============================================================================
+/*{{{*/
+TEST(ArenaMemory, CloneIntoArena)
+{
+    int A[]{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    graal::Arena arena;
+
+    graal::Buffer result = graal::clone( std::begin(A)+3, std::end(A), sizeof(A[0]), arena );
+    ASSERT_EQ( result.size(), 7*sizeof(int) );
+    ASSERT_EQ( reinterpret_cast< std::uintptr_t >( result.data() ) % graal::CACHE_LINE, 0u );
+    ASSERT_TRUE( std::equal( std::begin(A)+3, std::end(A), result.as< int >() ) );
+}
+
+TEST(ArenaMemory, ResetReusesBlocks)
+{
+    graal::Arena arena( 1024 );
+
+    void *a = arena.allocate( 100, 16 );
+    arena.allocate( 2000, 64 );
+    ASSERT_GE( arena.used(), 2100u );
+
+    arena.reset();
+    ASSERT_EQ( arena.used(), 0u );
+    ASSERT_EQ( arena.allocate( 100, 16 ), a );
+}
+
+TEST(ArenaMemory, BufferIsMoveOnly)
+{
+    char A[]{ 'a', 'b', 'c' };
+
+    graal::Buffer b1 = graal::clone( std::begin(A), std::end(A), sizeof(A[0]), graal::default_allocator() );
+    graal::Buffer b2( std::move( b1 ) );
+    ASSERT_FALSE( b1 );
+    ASSERT_TRUE( b2 );
+    ASSERT_EQ( 0, std::memcmp( b2.data(), A, sizeof(A) ) );
+}
+
+/* Counts what goes through it, so tests can tell the algorithm used it */
+struct CountingAllocator : graal::Allocator
+{
+    size_t allocations = 0, live = 0;
+
+    void *allocate( size_t bytes, size_t align ) override
+    {
+        ++allocations;
+        ++live;
+        return graal::default_allocator().allocate( bytes, align );
+    }
+
+    void deallocate( void *p, size_t bytes ) override
+    {
+        --live;
+        graal::default_allocator().deallocate( p, bytes );
+    }
+};
+
+TEST(ArenaMemory, ScratchUsersTakeAllocator)
+{
+    std::vector< int > base( 5000 );
+    for( size_t i = 0; i < base.size(); ++i ) base[i] = (int)( (i * 7919) % 1000 );
+    std::vector< int > sorted( base );
+    std::sort( sorted.begin(), sorted.end() );
+    CountingAllocator alloc;
+    std::vector< int > A;
+
+    A = base;
+    graal::stable_sort( A.data(), A.size(), sizeof(int), INT_sort_comp, SIZE_MAX, alloc );
+    ASSERT_TRUE( A == sorted );
+    size_t antes = alloc.allocations;
+    ASSERT_GT( antes, 0u );
+
+    A = base;
+    graal::radix_sort( A.data(), A.size(), sizeof(int), graal::Key( 0, graal::ElementType::Int32 ), nullptr, alloc );
+    ASSERT_TRUE( A == sorted );
+    ASSERT_GT( alloc.allocations, antes );
+    antes = alloc.allocations;
+
+    A = base;
+    graal::stable_partition( A.data(), A.data()+A.size(), sizeof(int), INT_bigg_than, SIZE_MAX, alloc );
+    ASSERT_GT( alloc.allocations, antes );
+    antes = alloc.allocations;
+
+    A = base;
+    int *fim = static_cast< int * >( graal::unique( A.data(), A.data()+A.size(), sizeof(int),
+            []( const void *a ) { return (size_t) *static_cast< const int * >(a); }, INT_equal_to, alloc ) );
+    ASSERT_EQ( fim - A.data(), 1000 );
+    ASSERT_GT( alloc.allocations, antes );
+    antes = alloc.allocations;
+
+    A = base;
+    fim = static_cast< int * >( graal::unique( A.data(), A.data()+A.size(), sizeof(int), graal::bitwise, 1024, alloc ) );
+    ASSERT_EQ( fim - A.data(), 1000 );
+    ASSERT_GT( alloc.allocations, antes );
+    antes = alloc.allocations;
+
+    A = base;
+    std::vector< uint32_t > idx( A.size() );
+    graal::argsort( A.data(), A.size(), sizeof(int), INT_sort_comp, idx.data() );
+    graal::apply_permutation( A.data(), A.size(), sizeof(int), idx.data(), alloc );
+    ASSERT_TRUE( A == sorted );
+    ASSERT_GT( alloc.allocations, antes );
+
+    ASSERT_EQ( alloc.live, 0u );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                    Tests for reverse_copy()
+// ============================================================================
+/*{{{*/
+TEST(ReverseCopy, LongCharArray)
+{
+    std::vector< char > A( 1000 ), B( 1000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = 'a' + i % 26;
+
+    auto result = graal::reverse_copy( A.data(), A.data()+A.size(), B.data(), sizeof(char) );
+    ASSERT_EQ( result, B.data()+B.size() );
+    ASSERT_TRUE( std::equal( A.rbegin(), A.rend(), B.begin() ) );
+}
+
+TEST(ReverseCopy, IrregularSize)
+{
+    Rec3 A[]{ { {'a','b','c'} }, { {'d','e','f'} }, { {'g','h','i'} } };
+    Rec3 B[3];
+
+    graal::reverse_copy( std::begin(A), std::end(A), std::begin(B), sizeof(A[0]) );
+    ASSERT_EQ( 0, std::memcmp( B, "ghidefabc", sizeof(B) ) );
+}
+/*}}}*/
+
+// ============================================================================
+//                                              Tests for block partition()
+// ============================================================================
+/*{{{*/
+bool INT_even( const void *a )
+{
+    return *static_cast< const int * >(a) % 2 == 0;
+}
+
+TEST(BlockPartition, TrueElementsKeepOrderAcrossBlocks)
+{
+    std::vector< int > A( 1000 ), A_E;
+    std::srand( 17 );
+    for( auto &x : A ) x = std::rand() % 100000;
+    std::copy_if( A.begin(), A.end(), std::back_inserter( A_E ), []( int x ) { return x % 2 == 0; } );
+
+    int *result = static_cast< int * >( graal::partition( A.data(), A.data() + A.size(), sizeof(int), INT_even ) );
+    ASSERT_EQ( result - A.data(), (long) A_E.size() );
+    ASSERT_TRUE( std::equal( A.data(), result, A_E.begin() ) );
+    ASSERT_TRUE( std::none_of( result, A.data() + A.size(), []( int x ) { return x % 2 == 0; } ) );
+}
+TEST(StablePartition, BothGroupsKeepOrder)
+{
+    int A[]{ 1, 2, 3, 5, 1, 4, 6, 0, 8, 7 };
+    int A_E[]{ 2, 4, 6, 0, 8, 1, 3, 5, 1, 7 };
+
+    int *result = static_cast< int * >( graal::stable_partition( std::begin(A), std::end(A), sizeof(A[0]), INT_even ) );
+    ASSERT_EQ( result - std::begin(A), 5 );
+    ASSERT_TRUE( std::equal( std::begin(A), std::end(A), std::begin(A_E) ) );
+}
+
+TEST(StablePartition, InPlaceAndBoundedBufferMatch)
+{
+    std::vector< int > A( 5000 ), A_E;
+    std::srand( 19 );
+    for( auto &x : A ) x = std::rand() % 100000;
+    A_E = A;
+    std::stable_partition( A_E.begin(), A_E.end(), []( int x ) { return x % 2 == 0; } );
+
+    for( size_t scratch : { (size_t) 0, (size_t) 256, (size_t) SIZE_MAX } )
+    {
+        std::vector< int > B = A;
+        graal::stable_partition( B.data(), B.data() + B.size(), sizeof(int), INT_even, scratch );
+        ASSERT_TRUE( B == A_E );
+    }
+}
+
+/*}}}*/
+
+// ============================================================================
+//                                            Tests for the batched predicates
+// ============================================================================
+/*{{{*/
+/* Batched version of INT_even: one call per block */
+size_t INT_even_batch( const void *block, size_t n, size_t sz, std::uint8_t *out )
+{
+    const int *v = static_cast< const int * >(block);
+    size_t count = 0;
+    for( size_t i = 0; i < n; ++i )
+        count += out[i] = ( v[i] % 2 == 0 );
+    return count;
+}
+
+TEST(BatchPredicate, FindAndQuantifiers)
+{
+    std::vector< int > A( 1000, 1 );
+    const int *f = A.data(), *l = A.data() + A.size();
+
+    ASSERT_EQ( graal::find_if( f, l, sizeof(int), INT_even_batch ), (const void *) l );
+    ASSERT_FALSE( graal::any_of( f, l, sizeof(int), INT_even_batch ) );
+    ASSERT_TRUE( graal::none_of( f, l, sizeof(int), INT_even_batch ) );
+
+    A[700] = 4;
+    A[900] = 6;
+    ASSERT_EQ( graal::find_if( f, l, sizeof(int), INT_even_batch ), (const void *)( f + 700 ) );
+    ASSERT_TRUE( graal::any_of( f, l, sizeof(int), INT_even_batch ) );
+    ASSERT_FALSE( graal::all_of( f, l, sizeof(int), INT_even_batch ) );
+
+    std::fill( A.begin(), A.end(), 2 );
+    ASSERT_TRUE( graal::all_of( f, l, sizeof(int), INT_even_batch ) );
+    ASSERT_TRUE( graal::all_of( f, f, sizeof(int), INT_even_batch ) );
+}
+
+TEST(BatchPredicate, PartitionMatchesPredicate)
+{
+    std::vector< int > A( 1000 ), B;
+    std::srand( 23 );
+    for( auto &x : A ) x = std::rand() % 1000;
+    B = A;
+
+    int *ra = static_cast< int * >( graal::partition( A.data(), A.data() + A.size(), sizeof(int), INT_even_batch ) );
+    int *rb = static_cast< int * >( graal::partition( B.data(), B.data() + B.size(), sizeof(int), INT_even ) );
+    ASSERT_EQ( ra - A.data(), rb - B.data() );
+    ASSERT_TRUE( A == B );
+}
+/*}}}*/
+
+// ============================================================================
+//                                              Tests for qsort() distributions
+// ============================================================================
+/*{{{*/
+/* Builds a sorted copy with std::sort to compare against */
+std::vector< int > SORTED( std::vector< int > v )
+{
+    std::sort( v.begin(), v.end() );
+    return v;
+}
+
+TEST(SortDistributions, RandomLarge)
+{
+    std::vector< int > A( 100000 );
+    std::srand( 3 );
+    for( auto &x : A ) x = std::rand();
+    auto A_O = SORTED( A );
+
+    graal::qsort( A.data(), A.size(), sizeof(int), INT_sort_comp );
+    ASSERT_TRUE( A == A_O );
+}
+
+TEST(SortDistributions, ReversedAndManyDuplicates)
+{
+    std::vector< int > A( 50000 ), B( 50000 );
+    for( size_t i = 0; i < A.size(); ++i ) { A[i] = A.size()-i; B[i] = i % 7; }
+    auto A_O = SORTED( A );
+    auto B_O = SORTED( B );
+
+    graal::qsort( A.data(), A.size(), sizeof(int), INT_sort_comp );
+    graal::qsort( B.data(), B.size(), sizeof(int), INT_sort_comp );
+    ASSERT_TRUE( A == A_O );
+    ASSERT_TRUE( B == B_O );
+}
+
+TEST(SortDistributions, WideRecords)
+{
+    std::vector< Rec24 > A( 3000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = Rec24{ (long long)( (i * 7919) % 3000 ), (long long) i, 0 };
+
+    graal::qsort( A.data(), A.size(), sizeof(Rec24), []( const void *a, const void *b )
+            { return static_cast< const Rec24 * >(a)->key < static_cast< const Rec24 * >(b)->key; } );
+    for( size_t i = 0; i < A.size(); ++i )
+        ASSERT_EQ( A[i].key, (long long) i );
+}
+
+TEST(SortDistributions, NaturalRuns)
+{
+    // Organ pipe, sawtooth and nearly sorted inputs take the run-merging path
+    const size_t N = 40000;
+    std::vector< std::vector< int > > entradas( 3, std::vector< int >( N ) );
+    std::srand( 5 );
+    for( size_t i = 0; i < N; ++i )
+    {
+        entradas[0][i] = i < N/2 ? i : N-i;
+        entradas[1][i] = i % (N/4);
+        entradas[2][i] = i;
+    }
+    for( int j = 0; j < 20; ++j )
+        std::swap( entradas[2][std::rand() % N], entradas[2][std::rand() % N] );
+
+    for( auto &A : entradas )
+    {
+        auto A_O = SORTED( A );
+        auto B = A;
+
+        graal::qsort( A.data(), A.size(), sizeof(int), INT_sort_comp );
+        graal::qsort( B.data(), B.size(), sizeof(int), graal::Key( 0, graal::ElementType::Int32 ) );
+        ASSERT_TRUE( A == A_O );
+        ASSERT_TRUE( B == A_O );
+    }
+}
+/*}}}*/
+
+// ============================================================================
+//                                                      Tests for radix_sort()
+// ============================================================================
+/*{{{*/
+/* Record with a signed key and its original position */
+struct KeyRec { int pos; int key; };
+
+TEST(RadixSort, SignedKeyIsStable)
+{
+    KeyRec A[]{ { 0, 5 }, { 1, -3 }, { 2, 5 }, { 3, 0 }, { 4, -3 }, { 5, -100000 } };
+    int A_O[]{ 5, 1, 4, 3, 0, 2 };
+
+    graal::radix_sort( std::begin(A), 6, sizeof(KeyRec),
+            graal::Key( offsetof(KeyRec, key), graal::ElementType::Int32 ) );
+    for( int i = 0; i < 6; ++i )
+        ASSERT_EQ( A[i].pos, A_O[i] );
+}
+
+TEST(RadixSort, FloatDescending)
+{
+    float A[]{ 1.5f, -2.0f, 0.25f, -0.5f, 100.0f, -7.0f };
+    float A_O[]{ 100.0f, 1.5f, 0.25f, -0.5f, -2.0f, -7.0f };
+
+    graal::radix_sort( std::begin(A), 6, sizeof(float), graal::Key( 0, graal::ElementType::Float, true ) );
+    ASSERT_TRUE( std::equal( std::begin(A), std::end(A), std::begin(A_O) ) );
+}
+
+TEST(RadixSort, KeyExtractorWithScratch)
+{
+    std::vector< int > A( 10000 ), scratch( 10000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = ( i * 7919 ) % 10000;
+
+    graal::radix_sort( A.data(), A.size(), sizeof(int),
+            []( const void *e ) { return static_cast< std::uint32_t >( *static_cast< const int * >(e) ); },
+            scratch.data() );
+    for( size_t i = 0; i < A.size(); ++i )
+        ASSERT_EQ( A[i], (int) i );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                     Tests for TypeOps
+// ============================================================================
+/*{{{*/
+/* Long enough to live on the heap, so byte copies would double free */
+std::string long_string( int i )
+{
+    return "a string that does not fit the small buffer #" + std::to_string(i);
+}
+
+size_t STR_hash( const void *a )
+{
+    return std::hash< std::string >()( *static_cast< const std::string * >(a) );
+}
+
+TEST(TypeOps, ReverseAndPartitionStrings)
+{
+    std::vector< std::string > A, E;
+    for(int i = 0; i < 9; ++i)
+        A.push_back( long_string(i) );
+    E.assign( A.rbegin(), A.rend() );
+    const graal::TypeOps &ops = graal::type_ops< std::string >();
+
+    graal::reverse( A.data(), A.data()+A.size(), sizeof(std::string), ops );
+    ASSERT_EQ( A, E );
+
+    // Strings ending in an even digit first, in their original order
+    auto even = []( const void *e ) { return static_cast< const std::string * >(e)->back() % 2 == 0; };
+    std::string *m = static_cast< std::string * >(
+            graal::partition( A.data(), A.data()+A.size(), sizeof(std::string), even, ops ) );
+    ASSERT_EQ( m, A.data()+5 );
+    for(int i = 0; i < 5; ++i)
+        ASSERT_EQ( A[i], long_string(8 - 2*i) );
+}
+
+TEST(TypeOps, UniqueStrings)
+{
+    std::vector< std::string > A, B;
+    for(int i = 0; i < 40; ++i)
+        A.push_back( long_string(i % 7) );
+    B = A;
+    const graal::TypeOps &ops = graal::type_ops< std::string >();
+
+    std::string *ra = static_cast< std::string * >(
+            graal::unique( A.data(), A.data()+A.size(), sizeof(std::string), STR_equal_to, ops ) );
+    std::string *rb = static_cast< std::string * >(
+            graal::unique( B.data(), B.data()+B.size(), sizeof(std::string), STR_hash, STR_equal_to, ops ) );
+    ASSERT_EQ( ra, A.data()+7 );
+    ASSERT_EQ( rb, B.data()+7 );
+    for(int i = 0; i < 7; ++i)
+    {
+        ASSERT_EQ( A[i], long_string(i) );
+        ASSERT_EQ( B[i], long_string(i) );
+    }
+}
+
+TEST(TypeOps, QsortStrings)
+{
+    std::srand( 41 );
+    std::vector< std::string > A;
+    for(int i = 0; i < 3000; ++i)
+        A.push_back( long_string(std::rand() % 1000) );
+    std::vector< std::string > E = A;
+    std::sort( E.begin(), E.end() );
+
+    graal::qsort( A.data(), A.size(), sizeof(std::string), STR_sort_comp, graal::type_ops< std::string >() );
+    ASSERT_EQ( A, E );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                 Tests for the Key variants
+// ============================================================================
+/*{{{*/
+/* Record with several key fields after a tag */
+struct KeyedRec { char tag; std::int16_t small; int key; double value; };
+
+TEST(KeyVariants, FindAndMin)
+{
+    KeyedRec A[]{ { 'a', 7, 5, 1.5 }, { 'b', -2, -3, -0.5 }, { 'c', 7, 9, 2.0 }, { 'd', 3, -3, -8.0 }, { 'e', -2, 9, 2.0 } };
+    graal::Key by_key( offsetof(KeyedRec, key), graal::ElementType::Int32 );
+    graal::Key by_small( offsetof(KeyedRec, small), graal::ElementType::Int16 );
+    graal::Key by_value( offsetof(KeyedRec, value), graal::ElementType::Double );
+
+    int k = 9;
+    ASSERT_EQ( graal::find( std::begin(A), std::end(A), sizeof(KeyedRec), &k, by_key ), std::begin(A)+2 );
+    k = 4;
+    ASSERT_EQ( graal::find( std::begin(A), std::end(A), sizeof(KeyedRec), &k, by_key ), std::end(A) );
+    double v = -8.0;
+    ASSERT_EQ( graal::find( std::begin(A), std::end(A), sizeof(KeyedRec), &v, by_value ), std::begin(A)+3 );
+
+    // First occurrence of the smallest (or, descending, the largest) key
+    ASSERT_EQ( graal::min( std::begin(A), std::end(A), sizeof(KeyedRec), by_key ), std::begin(A)+1 );
+    ASSERT_EQ( graal::min( std::begin(A), std::end(A), sizeof(KeyedRec), by_small ), std::begin(A)+1 );
+    ASSERT_EQ( graal::min( std::begin(A), std::end(A), sizeof(KeyedRec),
+            graal::Key( offsetof(KeyedRec, key), graal::ElementType::Int32, true ) ), std::begin(A)+2 );
+    ASSERT_EQ( graal::min( std::begin(A), std::end(A), sizeof(KeyedRec), by_value ), std::begin(A)+3 );
+    ASSERT_EQ( graal::min( std::begin(A), std::begin(A), sizeof(KeyedRec), by_key ), std::begin(A) );
+}
+
+TEST(KeyVariants, LargeRangesMatchCallbacks)
+{
+    std::srand( 31 );
+    std::vector< KeyedRec > A( 5000 );
+    for(size_t i = 0; i < A.size(); ++i)
+        A[i] = KeyedRec{ char(i), std::int16_t(std::rand() % 100 - 50), std::rand() % 2000 - 1000, double(i) };
+    graal::Key by_key( offsetof(KeyedRec, key), graal::ElementType::Int32 );
+    auto key_less = []( const void *a, const void *b )
+    {
+        return static_cast< const KeyedRec * >(a)->key < static_cast< const KeyedRec * >(b)->key;
+    };
+    const KeyedRec *f = A.data(), *l = A.data()+A.size();
+
+    ASSERT_EQ( graal::min( f, l, sizeof(KeyedRec), by_key ), graal::min( f, l, sizeof(KeyedRec), key_less ) );
+    int k = A[4321].key;
+    const KeyedRec *r = static_cast< const KeyedRec * >( graal::find( f, l, sizeof(KeyedRec), &k, by_key ) );
+    ASSERT_EQ( r, &*std::find_if( A.begin(), A.end(), [k]( const KeyedRec &e ) { return e.key == k; } ) );
+
+    // Partition keeps the order of the elements before the pivot
+    std::vector< KeyedRec > P = A;
+    k = 0;
+    KeyedRec *m = static_cast< KeyedRec * >( graal::partition( P.data(), P.data()+P.size(), sizeof(KeyedRec), by_key, &k ) );
+    std::vector< KeyedRec > E;
+    for(auto &e : A)
+        if(e.key < 0)
+            E.push_back( e );
+    ASSERT_EQ( size_t(m - P.data()), E.size() );
+    for(size_t i = 0; i < E.size(); ++i)
+        ASSERT_EQ( P[i].value, E[i].value );
+    for(KeyedRec *it = m; it != P.data()+P.size(); ++it)
+        ASSERT_GE( it->key, 0 );
+
+    // qsort by a descending key gives the same keys as std::sort
+    std::vector< KeyedRec > S = A;
+    graal::qsort( S.data(), S.size(), sizeof(KeyedRec), graal::Key( offsetof(KeyedRec, small), graal::ElementType::Int16, true ) );
+    std::vector< int > esperado;
+    for(auto &e : A)
+        esperado.push_back( e.small );
+    std::sort( esperado.begin(), esperado.end(), []( int a, int b ) { return a > b; } );
+    for(size_t i = 0; i < S.size(); ++i)
+        ASSERT_EQ( S[i].small, esperado[i] );
+}
+
+TEST(KeyVariants, QsortDoubleAndUnique)
+{
+    double A[]{ 2.5, -1.0, 0.0, -0.0, 1e300, -3.25, 2.5 };
+    double A_O[]{ -3.25, -1.0, -0.0, 0.0, 2.5, 2.5, 1e300 };
+    graal::qsort( std::begin(A), 7, sizeof(double), graal::Key( 0, graal::ElementType::Double ) );
+    for(int i = 0; i < 7; ++i)
+    {
+        ASSERT_EQ( A[i], A_O[i] );
+        ASSERT_EQ( std::signbit(A[i]), std::signbit(A_O[i]) );
+    }
+
+    // Keeps the first record of each key, in the original order
+    KeyedRec B[]{ { 'a', 1, 5, 0 }, { 'b', 2, 7, 0 }, { 'c', 3, 5, 0 }, { 'd', 4, -1, 0 }, { 'e', 5, 7, 0 } };
+    KeyedRec *r = static_cast< KeyedRec * >( graal::unique( std::begin(B), std::end(B), sizeof(KeyedRec),
+            graal::Key( offsetof(KeyedRec, key), graal::ElementType::Int32 ) ) );
+    ASSERT_EQ( r, std::begin(B)+3 );
+    ASSERT_EQ( B[0].tag, 'a' );
+    ASSERT_EQ( B[1].tag, 'b' );
+    ASSERT_EQ( B[2].tag, 'd' );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                Tests for unique() with hash
+// ============================================================================
+/*{{{*/
+size_t INT_hash( const void *a )
+{
+    return static_cast< size_t >( *static_cast< const int * >(a) );
+}
+
+TEST(HashUnique, KeepsFirstOccurrenceOrder)
+{
+    int A[]{ 1, 2, 5, 2, 5, 1, 9, 9, 5, 2 };
+    int A_E[]{ 1, 2, 5, 9 };
+
+    int *result = static_cast< int * >(
+            graal::unique( std::begin(A), std::end(A), sizeof(A[0]), INT_hash, INT_equal_to ) );
+    ASSERT_EQ( result - std::begin(A), 4 );
+    ASSERT_TRUE( std::equal( std::begin(A), result, std::begin(A_E) ) );
+}
+
+TEST(HashUnique, LargeRangeMatchesQuadratic)
+{
+    std::vector< int > A( 20000 ), B;
+    std::srand( 11 );
+    for( auto &x : A ) x = std::rand() % 3000;
+    B = A;
+
+    int *ra = static_cast< int * >( graal::unique( A.data(), A.data() + A.size(), sizeof(int), INT_hash, INT_equal_to ) );
+    int *rb = static_cast< int * >( graal::unique( B.data(), B.data() + B.size(), sizeof(int), INT_equal_to ) );
+    ASSERT_EQ( ra - A.data(), rb - B.data() );
+    ASSERT_TRUE( std::equal( A.data(), ra, B.data() ) );
+
+    // A second call reuses the table and must not see the first call's values
+    int C[]{ 7, 7, 1 };
+    int *rc = static_cast< int * >( graal::unique( std::begin(C), std::end(C), sizeof(int), INT_hash, INT_equal_to ) );
+    ASSERT_EQ( rc - std::begin(C), 2 );
+
+    // After the table is released the next call allocates a fresh one
+    graal::unique_release_scratch();
+    graal::unique_release_scratch();
+    int D[]{ 3, 4, 3, 4, 5 };
+    int *rd = static_cast< int * >( graal::unique( std::begin(D), std::end(D), sizeof(int), INT_hash, INT_equal_to ) );
+    ASSERT_EQ( rd - std::begin(D), 3 );
+}
+
+TEST(HashUnique, BoundedMemoryMatchesUnbounded)
+{
+    std::vector< int > A( 20000 ), B;
+    std::srand( 13 );
+    for( auto &x : A ) x = std::rand() % 8000;
+    B = A;
+
+    // 4KB cannot hold the whole table or all the marks, so the hash is split into ranges
+    int *ra = static_cast< int * >( graal::unique( A.data(), A.data() + A.size(), sizeof(int), INT_hash, INT_equal_to, 4096 ) );
+    int *rb = static_cast< int * >( graal::unique( B.data(), B.data() + B.size(), sizeof(int), INT_hash, INT_equal_to ) );
+    ASSERT_EQ( ra - A.data(), rb - B.data() );
+    ASSERT_TRUE( std::equal( A.data(), ra, B.data() ) );
+}
+
+size_t hash_calls = 0;
+
+size_t INT_counting_hash( const void *a )
+{
+    ++hash_calls;
+    return INT_hash( a );
+}
+
+TEST(HashUnique, BoundedMemoryPassCount)
+{
+    const size_t n = 20000;
+    std::vector< int > A( n ), B;
+    for( size_t i = 0; i < n; ++i ) A[i] = (int)( (i * 7919) % n );
+    for( size_t i = 0; i < n; i += 3 ) A[i] = A[i / 2];
+    B = A;
+
+    // Bitmap (in 64-bit words) plus a quarter of the marks: about four passes
+    size_t bitmap = (n + 63) / 64 * 8;
+    size_t budget = bitmap + 8 * (n / 4);
+    hash_calls = 0;
+    int *ra = static_cast< int * >( graal::unique( A.data(), A.data() + n, sizeof(int), INT_counting_hash, INT_equal_to, budget ) );
+    ASSERT_LE( hash_calls, 6 * n );
+
+    int *rb = static_cast< int * >( graal::unique( B.data(), B.data() + n, sizeof(int), INT_hash, INT_equal_to ) );
+    ASSERT_EQ( ra - A.data(), rb - B.data() );
+    ASSERT_TRUE( std::equal( A.data(), ra, B.data() ) );
+
+    // All marks fit: a single pass
+    A = B = std::vector< int >( n );
+    for( size_t i = 0; i < n; ++i ) A[i] = B[i] = (int)( (i * 7919) % (n / 2) );
+    hash_calls = 0;
+    ra = static_cast< int * >( graal::unique( A.data(), A.data() + n, sizeof(int), INT_counting_hash, INT_equal_to, bitmap + 8 * n ) );
+    ASSERT_EQ( hash_calls, n );
+    rb = static_cast< int * >( graal::unique( B.data(), B.data() + n, sizeof(int), INT_equal_to ) );
+    ASSERT_EQ( ra - A.data(), rb - B.data() );
+    ASSERT_TRUE( std::equal( A.data(), ra, B.data() ) );
+}
+
+TEST(HashUnique, BoundedMemoryWithCollidingHash)
+{
+    int A[]{ 1, 5, 3, 3, 5, 10, 1, 7, 8, 9, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 3 };
+    int A_E[]{ 1, 5, 3, 10, 7, 8, 9, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+
+    auto zero = []( const void * ) { return (size_t) 0; };
+
+    // The minimum budget: one 64-bit bitmap word plus 16 table entries of 8 bytes
+    int *result = static_cast< int * >( graal::unique( std::begin(A), std::end(A), sizeof(A[0]), zero, INT_equal_to, 8 + 16*8 ) );
+    ASSERT_EQ( result - std::begin(A), 17 );
+    ASSERT_TRUE( std::equal( std::begin(A), result, std::begin(A_E) ) );
+}
+
+TEST(HashUnique, BoundedMemoryBelowMinimumThrows)
+{
+    std::vector< int > A( 1000, 5 );
+    ASSERT_THROW( graal::unique( A.data(), A.data() + A.size(), sizeof(int), INT_hash, INT_equal_to, 0 ), std::invalid_argument );
+    ASSERT_THROW( graal::unique( A.data(), A.data() + A.size(), sizeof(int), graal::bitwise, 128 + 16*8 - 1 ), std::invalid_argument );
+
+    // At the minimum the call succeeds and leaves a single element
+    int *r = static_cast< int * >( graal::unique( A.data(), A.data() + A.size(), sizeof(int), graal::bitwise, 128 + 16*8 ) );
+    ASSERT_EQ( r - A.data(), 1 );
+    ASSERT_EQ( A[0], 5 );
+
+    // A budget that holds the whole table needs no bitmap
+    int B[]{ 1, 2, 1 };
+    r = static_cast< int * >( graal::unique( std::begin(B), std::end(B), sizeof(int), graal::bitwise, 16*8 ) );
+    ASSERT_EQ( r - std::begin(B), 2 );
+}
+
+TEST(HashUnique, Bitwise)
+{
+    char A[]{ 'a', 'b', 'h', 'b', 'h', 'a', 'j', 'j' };
+    char A_E[]{ 'a', 'b', 'h', 'j' };
+    char *ra = static_cast< char * >( graal::unique( std::begin(A), std::end(A), sizeof(A[0]), graal::bitwise ) );
+    ASSERT_EQ( ra - std::begin(A), 4 );
+    ASSERT_TRUE( std::equal( std::begin(A), ra, std::begin(A_E) ) );
+
+    Rec24 B[]{ { 1, 2, 3 }, { 4, 5, 6 }, { 1, 2, 3 }, { 1, 2, 4 } };
+    Rec24 *rb = static_cast< Rec24 * >( graal::unique( std::begin(B), std::end(B), sizeof(B[0]), graal::bitwise ) );
+    ASSERT_EQ( rb - std::begin(B), 3 );
+    ASSERT_EQ( B[2].b, 4 );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                     Tests for stable_sort()
+// ============================================================================
+/*{{{*/
+TEST(StableSort, EqualKeysKeepOrder)
+{
+    std::vector< KeyRec > A( 5000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = KeyRec{ (int) i, (int)( (i * 7919) % 13 ) };
+
+    graal::stable_sort( A.data(), A.size(), sizeof(KeyRec), []( const void *a, const void *b )
+            { return static_cast< const KeyRec * >(a)->key < static_cast< const KeyRec * >(b)->key; } );
+    for( size_t i = 1; i < A.size(); ++i )
+    {
+        ASSERT_LE( A[i-1].key, A[i].key );
+        if( A[i-1].key == A[i].key ) { ASSERT_LT( A[i-1].pos, A[i].pos ); }
+    }
+}
+
+TEST(StableSort, ConcatenatedRuns)
+{
+    // Four ascending runs followed by a descending one
+    std::vector< int > A;
+    for( int r = 0; r < 4; ++r )
+        for( int i = 0; i < 3000; ++i ) A.push_back( i*4 + r );
+    for( int i = 3000; i > 0; --i ) A.push_back( i );
+    auto A_O = SORTED( A );
+
+    size_t used = graal::stable_sort( A.data(), A.size(), sizeof(int), INT_sort_comp );
+    ASSERT_TRUE( A == A_O );
+    ASSERT_GT( used, 0u );
+    ASSERT_LE( used, A.size()/2 * sizeof(int) );
+}
+
+TEST(StableSort, BoundedScratch)
+{
+    std::vector< KeyRec > A( 20000 );
+    std::srand( 9 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = KeyRec{ (int) i, std::rand() % 100 };
+
+    size_t used = graal::stable_sort( A.data(), A.size(), sizeof(KeyRec), []( const void *a, const void *b )
+            { return static_cast< const KeyRec * >(a)->key < static_cast< const KeyRec * >(b)->key; }, 1024 );
+    ASSERT_LE( used, 1024u );
+    for( size_t i = 1; i < A.size(); ++i )
+    {
+        ASSERT_LE( A[i-1].key, A[i].key );
+        if( A[i-1].key == A[i].key ) { ASSERT_LT( A[i-1].pos, A[i].pos ); }
+    }
+}
+/*}}}*/
+
+// ============================================================================
+//                              Tests for lower_bound() and the sorted searches
+// ============================================================================
+/*{{{*/
+TEST(SortedSearch, MatchesStd)
+{
+    std::srand( 21 );
+    for(size_t n : { 0, 1, 2, 3, 7, 64, 1000, 4097 })
+    {
+        std::vector< int > A( n );
+        for(auto &x : A)
+            x = std::rand() % 50;
+        graal::qsort( A.data(), A.size(), sizeof(int), INT_sort_comp );
+        const int *f = A.data(), *l = A.data()+A.size();
+
+        for(int value = -1; value <= 51; ++value)
+        {
+            const int *lo = f + (std::lower_bound( A.begin(), A.end(), value ) - A.begin());
+            const int *hi = f + (std::upper_bound( A.begin(), A.end(), value ) - A.begin());
+
+            ASSERT_EQ( graal::lower_bound( f, l, sizeof(int), &value, INT_sort_comp ), lo );
+            ASSERT_EQ( graal::upper_bound( f, l, sizeof(int), &value, INT_sort_comp ), hi );
+            auto r = graal::equal_range( f, l, sizeof(int), &value, INT_sort_comp );
+            ASSERT_EQ( r.first, lo );
+            ASSERT_EQ( r.second, hi );
+            ASSERT_EQ( graal::binary_search( f, l, sizeof(int), &value, INT_sort_comp ), lo != hi );
+        }
+    }
+}
+
+TEST(SortedSearch, RecordsByKey)
+{
+    struct Rec { int key; char tag[8]; };
+    std::vector< Rec > A( 300 );
+    for(size_t i = 0; i < A.size(); ++i)
+        A[i] = Rec{ int(i/3)*2, { char('a' + i%3) } };
+
+    auto menor = []( const void *a, const void *b )
+    {
+        return static_cast< const Rec * >(a)->key < static_cast< const Rec * >(b)->key;
+    };
+    const Rec *f = A.data(), *l = A.data()+A.size();
+
+    Rec v{ 84, {} };
+    auto r = graal::equal_range( f, l, sizeof(Rec), &v, menor );
+    ASSERT_EQ( r.first, f+126 );
+    ASSERT_EQ( r.second, f+129 );
+
+    // Odd keys are missing: empty range at the insertion point
+    v.key = 85;
+    ASSERT_FALSE( graal::binary_search( f, l, sizeof(Rec), &v, menor ) );
+    ASSERT_EQ( graal::lower_bound( f, l, sizeof(Rec), &v, menor ), f+129 );
+    v.key = 1000;
+    ASSERT_EQ( graal::upper_bound( f, l, sizeof(Rec), &v, menor ), l );
+}
+
+TEST(SortedSearch, BatchMatchesSingle)
+{
+    std::srand( 23 );
+    for(size_t n : { 0, 1, 5, 100, 20000 })
+    {
+        std::vector< int > A( n );
+        for(auto &x : A)
+            x = std::rand() % 1000;
+        graal::qsort( A.data(), A.size(), sizeof(int), INT_sort_comp );
+        const int *f = A.data(), *l = A.data()+A.size();
+
+        // Not a multiple of the group size, so the last group is partial
+        std::vector< int > K( 37 );
+        for(auto &x : K)
+            x = std::rand() % 1100 - 50;
+        std::vector< size_t > lo( K.size() ), hi( K.size() );
+        graal::batch_lower_bound( f, l, sizeof(int), K.data(), K.size(), lo.data(), INT_sort_comp );
+        graal::batch_upper_bound( f, l, sizeof(int), K.data(), K.size(), hi.data(), INT_sort_comp );
+
+        for(size_t i = 0; i < K.size(); ++i)
+        {
+            ASSERT_EQ( f + lo[i], graal::lower_bound( f, l, sizeof(int), &K[i], INT_sort_comp ) );
+            ASSERT_EQ( f + hi[i], graal::upper_bound( f, l, sizeof(int), &K[i], INT_sort_comp ) );
+        }
+    }
+}
+/*}}}*/
+
+// ============================================================================
+//                                            Tests for the parallel searches
+// ============================================================================
+/*{{{*/
+bool INT_negative( const void *a )
+{
+    return *static_cast< const int * >(a) < 0;
+}
+
+bool INT_positive( const void *a )
+{
+    return *static_cast< const int * >(a) > 0;
+}
+
+TEST(ParallelFind, ReturnsFirstMatch)
+{
+    std::vector< int > A( 200000, 1 );
+    A[150000] = -1;
+    A[70001] = -2;
+    A[199999] = -3;
+    int value = -3;
+
+    // Threshold 0 forces the parallel path even on a single core
+    ASSERT_EQ( graal::parallel_find_if( A.data(), A.data() + A.size(), sizeof(int), INT_negative, 4, 0 ), A.data() + 70001 );
+    ASSERT_EQ( graal::parallel_find( A.data(), A.data() + A.size(), sizeof(int), &value, INT_equal_to, 4, 0 ), A.data() + 199999 );
+    ASSERT_EQ( graal::parallel_find( A.data(), A.data() + A.size(), sizeof(int), &value, graal::bitwise, 3, 0 ), A.data() + 199999 );
+    value = 7;
+    ASSERT_EQ( graal::parallel_find( A.data(), A.data() + A.size(), sizeof(int), &value, graal::bitwise, 3, 0 ), A.data() + A.size() );
+}
+
+TEST(ParallelFind, Quantifiers)
+{
+    std::vector< int > A( 200000, 1 );
+    const int *f = A.data(), *l = A.data() + A.size();
+
+    ASSERT_FALSE( graal::parallel_any_of( f, l, sizeof(int), INT_negative, 4, 0 ) );
+    ASSERT_TRUE( graal::parallel_none_of( f, l, sizeof(int), INT_negative, 4, 0 ) );
+    ASSERT_TRUE( graal::parallel_all_of( f, l, sizeof(int), INT_positive, 4, 0 ) );
+
+    A[123456] = -1;
+    ASSERT_TRUE( graal::parallel_any_of( f, l, sizeof(int), INT_negative, 4, 0 ) );
+    ASSERT_FALSE( graal::parallel_none_of( f, l, sizeof(int), INT_negative, 4, 0 ) );
+    ASSERT_FALSE( graal::parallel_all_of( f, l, sizeof(int), INT_positive, 4, 0 ) );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                  Tests for parallel_qsort()
+// ============================================================================
+/*{{{*/
+TEST(ParallelSort, ForcedThreadsRandom)
+{
+    std::vector< int > A( 60000 );
+    std::srand( 5 );
+    for( auto &x : A ) x = std::rand();
+    auto A_O = SORTED( A );
+
+    graal::parallel_qsort( A.data(), A.size(), sizeof(int), INT_sort_comp, 4, 0 );
+    ASSERT_TRUE( A == A_O );
+}
+
+TEST(ParallelSort, FewDistinctValues)
+{
+    std::vector< int > A( 40000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = i % 3;
+    auto A_O = SORTED( A );
+
+    graal::parallel_qsort( A.data(), A.size(), sizeof(int), INT_sort_comp, 3, 0 );
+    ASSERT_TRUE( A == A_O );
+}
+
+TEST(ParallelSort, WideRecords)
+{
+    std::vector< Rec24 > A( 20000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = Rec24{ (long long)( (i * 7919) % 20000 ), (long long) i, 0 };
+
+    graal::parallel_qsort( A.data(), A.size(), sizeof(Rec24), []( const void *a, const void *b )
+            { return static_cast< const Rec24 * >(a)->key < static_cast< const Rec24 * >(b)->key; }, 2, 0 );
+    for( size_t i = 0; i < A.size(); ++i )
+        ASSERT_EQ( A[i].key, (long long) i );
+}
+
+TEST(ParallelSort, HeavyKeys)
+{
+    // Two values fill most of the range and take equality buckets
+    std::vector< int > A( 100000 );
+    std::srand( 6 );
+    for( auto &x : A )
+    {
+        int r = std::rand() % 10;
+        x = r < 5 ? 42 : r < 8 ? -1 : std::rand();
+    }
+    auto A_O = SORTED( A );
+
+    graal::parallel_qsort( A.data(), A.size(), sizeof(int), INT_sort_comp, 4, 0 );
+    ASSERT_TRUE( A == A_O );
+
+    std::vector< int > B( 50000, 7 );
+    graal::parallel_qsort( B.data(), B.size(), sizeof(int), INT_sort_comp, 3, 0 );
+    ASSERT_TRUE( std::all_of( B.begin(), B.end(), []( int x ) { return x == 7; } ) );
+}
+
+bool INT_throwing_comp( const void *a, const void *b )
+{
+    if(*static_cast< const int * >(a) == 777 || *static_cast< const int * >(b) == 777)
+        throw std::runtime_error( "comparison failed" );
+    return INT_sort_comp( a, b );
+}
+
+TEST(ParallelSort, ExceptionReachesCaller)
+{
+    std::vector< int > A( 60000 );
+    for( size_t i = 0; i < A.size(); ++i ) A[i] = (int)( (i * 7919) % 60000 ) + 1000;
+    A[ 45000 ] = 777;
+
+    ASSERT_THROW( graal::parallel_qsort( A.data(), A.size(), sizeof(int), INT_throwing_comp, 4, 0 ), std::runtime_error );
+}
+/*}}}*/
+
+// ============================================================================
+//                                                     Tests for argsort
+// ============================================================================
+/*{{{*/
+/* Wider than the 256-byte stack temporary of apply_permutation */
+struct WideRec
+{
+    int key;
+    int id;
+    char pad[ 292 ];
+};
+
+bool WIDE_key_less( const void *a, const void *b )
+{
+    return static_cast< const WideRec * >(a)->key < static_cast< const WideRec * >(b)->key;
+}
+
+std::vector< WideRec > make_wide( size_t n )
+{
+    std::vector< WideRec > A( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        A[i].key = (int)( (i * 7919) % 1009 );
+        A[i].id = (int) i;
+        std::memset( A[i].pad, (int)( i & 0xff ), sizeof(A[i].pad) );
+    }
+    return A;
+}
+
+TEST(Argsort, OrdersIndicesAndLeavesRecords)
+{
+    auto A = make_wide( 5000 );
+    std::vector< uint32_t > idx( A.size() );
+
+    graal::argsort( A.data(), A.size(), sizeof(WideRec), WIDE_key_less, idx.data() );
+
+    // Records untouched, indices a permutation in key order.
+    for( size_t i = 0; i < A.size(); ++i )
+        ASSERT_EQ( A[i].id, (int) i );
+    std::vector< uint32_t > seen( idx );
+    std::sort( seen.begin(), seen.end() );
+    for( size_t i = 0; i < seen.size(); ++i )
+        ASSERT_EQ( seen[i], (uint32_t) i );
+    for( size_t i = 1; i < idx.size(); ++i )
+        ASSERT_LE( A[ idx[i-1] ].key, A[ idx[i] ].key );
+}
+
+TEST(Argsort, ApplyPermutationSortsRecords)
+{
+    auto A = make_wide( 3000 );
+    std::vector< uint64_t > idx( A.size() );
+
+    graal::argsort( A.data(), A.size(), sizeof(WideRec), WIDE_key_less, idx.data() );
+    graal::apply_permutation( A.data(), A.size(), sizeof(WideRec), idx.data() );
+
+    for( size_t i = 0; i < A.size(); ++i )
+    {
+        ASSERT_EQ( A[i].id, (int) idx[i] );
+        ASSERT_EQ( A[i].pad[0], (char)( idx[i] & 0xff ) );
+        ASSERT_EQ( A[i].pad[ sizeof(A[i].pad)-1 ], (char)( idx[i] & 0xff ) );
+        if( i > 0 )
+        {
+            ASSERT_LE( A[i-1].key, A[i].key );
+        }
+    }
+}
+
+TEST(Argsort, ApplyPermutationCycles)
+{
+    // Identity, one long cycle, and many 2-cycles, on several kernel sizes.
+    const size_t n = 257;
+    std::vector< uint32_t > ident( n ), rot( n ), swaps( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        ident[i] = (uint32_t) i;
+        rot[i] = (uint32_t)( (i + 1) % n );
+        swaps[i] = (uint32_t)( i + 1 < n ? i ^ 1 : i );
+    }
+
+    for( auto *perm : { &ident, &rot, &swaps } )
+    {
+        std::vector< int > A( n );
+        std::vector< long long > L( n );
+        for( size_t i = 0; i < n; ++i ) { A[i] = (int) i; L[i] = (long long) i * 3; }
+
+        graal::apply_permutation( A.data(), n, sizeof(int), perm->data() );
+        graal::apply_permutation( L.data(), n, sizeof(long long), perm->data() );
+        for( size_t i = 0; i < n; ++i )
+        {
+            ASSERT_EQ( A[i], (int) (*perm)[i] );
+            ASSERT_EQ( L[i], (long long) (*perm)[i] * 3 );
+        }
+    }
+}
+
+TEST(Argsort, GatherReordersParallelArray)
+{
+    std::vector< int > keys{ 5, 1, 4, 2, 3 };
+    std::vector< double > vals{ 0.5, 0.1, 0.4, 0.2, 0.3 };
+    std::vector< uint32_t > idx( keys.size() );
+
+    graal::argsort( keys.data(), keys.size(), sizeof(int), INT_sort_comp, idx.data() );
+
+    std::vector< double > out( vals.size() );
+    graal::gather( vals.data(), vals.size(), sizeof(double), idx.data(), out.data() );
+    ASSERT_EQ( out, ( std::vector< double >{ 0.1, 0.2, 0.3, 0.4, 0.5 } ) );
+
+    // scatter with the same indices undoes the gather.
+    std::vector< double > back( vals.size() );
+    graal::scatter( out.data(), out.size(), sizeof(double), idx.data(), back.data() );
+    ASSERT_EQ( back, vals );
+}
+
+TEST(Argsort, GatherScatterWide)
+{
+    auto A = make_wide( 1000 );
+    std::vector< uint64_t > idx( A.size() );
+    graal::argsort( A.data(), A.size(), sizeof(WideRec), WIDE_key_less, idx.data() );
+
+    std::vector< WideRec > G( A.size() ), S( A.size() );
+    graal::gather( A.data(), A.size(), sizeof(WideRec), idx.data(), G.data() );
+    graal::scatter( G.data(), G.size(), sizeof(WideRec), idx.data(), S.data() );
+    for( size_t i = 0; i < A.size(); ++i )
+    {
+        ASSERT_EQ( G[i].id, (int) idx[i] );
+        ASSERT_EQ( 0, std::memcmp( &S[i], &A[i], sizeof(WideRec) ) );
+    }
+}
+
+TEST(Argsort, EmptyAndSingle)
+{
+    int x = 7;
+    uint32_t idx = 99;
+    graal::argsort( &x, 0, sizeof(int), INT_sort_comp, &idx );
+    ASSERT_EQ( idx, 99u );
+    graal::argsort( &x, 1, sizeof(int), INT_sort_comp, &idx );
+    ASSERT_EQ( idx, 0u );
+    graal::apply_permutation( &x, 1, sizeof(int), &idx );
+    ASSERT_EQ( x, 7 );
+}
+
+TEST(Argsort, Rejects32BitIndicesPastRange)
+{
+    // The check comes before any record is read
+    if(sizeof(size_t) > sizeof(uint32_t))
+    {
+        uint32_t idx = 0;
+        ASSERT_THROW( graal::argsort( nullptr, (size_t) UINT32_MAX + 1, sizeof(int), INT_sort_comp, &idx ), std::invalid_argument );
+    }
+}
+/*}}}*/
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);